@@ -18,6 +18,10 @@
 #include "HgL_Log.h"
 #define HGL_ARENA_IMPLEMENTATION
 #include "HgL_Arena.h"
+#define HGL_POOL_IMPLEMENTATION
+#include "HgL_Pool.h"
+#define HGL_PARSE_IMPLEMENTATION
+#include "HgL_Parse.h"
 
 typedef struct HgGameCode HgGameCode; /* Defined later in document */
 
@@ -37,6 +41,18 @@ bool hgCheckGameHotLoad(HgGameCode *gameCode);
 /* Intitalize game engine */
 int hgInitEngine(void);
 
+/* Map a .hgpak, files in it are found before loose files */
+int hgMountPak(const char* filepath);
+
+/* Read changes to watched files, called once at the start of each frame */
+void hgUpdateFileWatch(void);
+
+/* Hand finished async file loads to their callbacks, once per frame */
+void hgUpdateFileLoads(void);
+
+/* Stop the async file loading threads, before game memory is freed */
+void hgStopFileLoads(void);
+
 /* Calculate the delta time for new frame */
 double hgCalculateDelta(void);
 
@@ -71,6 +87,9 @@ void hgCleanupEngine(void);
 #define SO_FILENAME_TEMP "libGame_temp.so"
 #endif /* HG_BUILD_DEBUG */
 
+/* Packed assets, made by make pak */
+#define PAK_FILE "res.hgpak"
+
 #include "entity.c"
 #include "camera.c"
 
@@ -84,11 +103,14 @@ struct HgGameCode {
   HgVersionInfo (*hgGetVersionInfo)(void);
   void (*hgStartGame)(HgArena *hgArena, HgGameState *gs);
   void (*hgGameLoop)(HgArena *arena,
+                     HgArena *frameArena,
                      HgGameState *gs,
                      HgInput *input, 
                      double delta);
   void (*hgEndGame)(HgArena *arena, HgGameState *gs);
   time_t modTime;
+  int watchId; /* watch on the shared object's directory */
+  bool isReloadPending;
 };
 
 HgGameCode gameCode = {0};
@@ -98,6 +120,7 @@ bool isRunning = true;
 
 HgGameState *gs;
 HgArena *arena;
+HgArena *frameArena;
 
 HgVersionInfo vi;
 
@@ -150,10 +173,12 @@ void hgStartGameStub(HgArena *arena, HgGameState *gs){
 }
 
 void hgGameLoopStub(HgArena *arena,
+                    HgArena *frameArena,
                     HgGameState *gs, 
                     HgInput *input, 
                     double delta){
   (void)(arena);
+  (void)(frameArena);
   (void)(gs);
   (void)(input);
   (void)(delta);
@@ -180,6 +205,7 @@ int main(void){
 
   int err = hgInitEngine();
   if(err){return err;}
+  hgMountPak(PAK_FILE);
   
   void *gameState = malloc(sizeof(HgGameState));
   if(gameState == NULL){
@@ -187,7 +213,31 @@ int main(void){
     return -1;
   }
  
-  arena = hgCreateArena(ALLOC_MEM_SIZE, 16);
+  /* Only reserved up front, pages are committed as the game uses them.
+   * If a game outgrows ALLOC_MEM_SIZE, more blocks get chained on.
+   * Huge pages keep TLB misses down, the arena is used all over. */
+  arena = hgCreateArenaEx(ALLOC_MEM_SIZE,
+                          16,
+                          HGL_ARENA_VIRTUAL
+                          | HGL_ARENA_GROWABLE
+                          | HGL_ARENA_HUGE_PAGES);
+  if(arena == NULL){
+    HG_FATAL("Failed to create engine memory arena!");
+    return -1;
+  }
+
+  frameArena = hgCreateArenaEx(FRAME_MEM_SIZE,
+                               16,
+                               HGL_ARENA_VIRTUAL
+                               | HGL_ARENA_GROWABLE
+                               | HGL_ARENA_HUGE_PAGES);
+  if(frameArena == NULL){
+    HG_FATAL("Failed to create frame memory arena!");
+    return -1;
+  }
+  hgArenaSetTag(frameArena, "frame");
+  /* Frame memory is faulted in now, not in the middle of a frame */
+  hgArenaPrefault(frameArena, FRAME_PREFAULT_SIZE);
 
   gs = gameState; 
 
@@ -200,9 +250,12 @@ int main(void){
   while(isRunning){
     delta = hgCalculateDelta();
     hgProcessInput(&input);
+    hgUpdateFileWatch();
+    hgUpdateFileLoads();
+    hgArenaPopAll(frameArena);
 
 #ifdef HG_BUILD_DEBUG
-    gameCode.hgGameLoop(arena, gs, &input, delta);
+    gameCode.hgGameLoop(arena, frameArena, gs, &input, delta);
     if(hgCheckGameHotLoad(&gameCode)){
       delayReload += delta;
       if (delayReload > HOTLOAD_DELAY){
@@ -212,12 +265,14 @@ int main(void){
       }
     }
 #else
-    hgGameLoop(arena, gs, &input, delta);
+    hgGameLoop(arena, frameArena, gs, &input, delta);
 #endif //HG_BUILD_DEBUG
 
     hgUpdateEngine();
   }
 
+  hgStopFileLoads();
+
 #ifdef HG_BUILD_DEBUG
   gameCode.hgEndGame(arena, gs);
 #else
@@ -225,6 +280,11 @@ int main(void){
 #endif //HG_BUILD_DEBUG
   
   hgCleanupEngine();
+  hgArenaLogStats(arena, "engine");
+  hgArenaLogStats(frameArena, "frame");
+  hgDestroyArena(frameArena);
+  hgDestroyArena(arena);
+  free(gameState);
   HG_LOG("Exiting");
 
 }
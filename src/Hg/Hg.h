@@ -54,6 +54,7 @@
  *************************************/
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <math.h>
 #include <time.h>
 
@@ -74,7 +75,12 @@
  * TODO move this somewhere else, users should not need to modify this file.
  */
 #include "HgL_Arena.h"
+#include "HgL_Pool.h"
 #define ALLOC_MEM_SIZE GIGABYTES(1)
+/* Scratch memory that is cleared at the start of every frame */
+#define FRAME_MEM_SIZE MEGABYTES(256)
+/* How much of the frame memory is faulted in at startup */
+#define FRAME_PREFAULT_SIZE MEGABYTES(16)
 
 /*********************************
  * Math Functions (cglm) (01.04) *
@@ -154,15 +160,80 @@ void hgGetFileStr(
   const char* filepath  /* filepath of file to get contents of */
 );
 
+/* Read only view of an entire file, mapped into memory */
+typedef struct HgFileMap{
+  const char* data; /* file contents, NOT null terminated */
+  size_t size;      /* size of file in bytes */
+  bool isInPak;     /* from the mounted .hgpak, not its own mapping */
+  bool isDecoded;   /* decompressed onto the heap, freed by hgUnmapFile */
+}HgFileMap;
+
+/* Map entire file into memory without copying it. data is NULL on failure.
+ * Files in the mounted .hgpak are found there first (in debug builds loose
+ * files come first, so they can be edited) */
+HgFileMap hgMapFile(const char* filepath);
+
+/* Same as hgMapFile, but compressed .hgpak files are decoded onto the arena
+ * instead of the heap. Pop them with the rest of the arena */
+HgFileMap hgMapFileEx(HgArena* hgArena, const char* filepath);
+
+/* Unmap a file mapped with hgMapFile or hgMapFileEx */
+void hgUnmapFile(HgFileMap* fileMap);
+
 /* Delete file at this location */
 void hgDeleteFile(const char* filepath);
 
 /* Copy file from fileSrc to fileDest filepaths */
 void hgCopyFile(const char* fileSrc, const char* fileDest);
 
-/* Returns the time since last modification of file */
+/* Returns the time since last modification of file, 0 if there's no file */
 time_t hgFileModTime(const char* filepath);
 
+/* Is there a file here, loose or in the .hgpak? Doesn't log if there isn't */
+bool hgFileExists(const char* filepath);
+
+/* Watch a file, or every file in a directory, for changes (finished writes
+ * and files moved in). Returns a watch id, or -1 on failure */
+int hgWatchFile(const char* filepath);
+
+/* Stop watching, watchId is from hgWatchFile */
+void hgUnwatchFile(int watchId);
+
+/* A watched file that changed since last frame */
+typedef struct HgFileChange{
+  int watchId;            /* id from hgWatchFile */
+  char name[PATH_LENGTH]; /* file in a watched directory, "" for a file */
+}HgFileChange;
+
+/* Changes since last frame, each file is only listed once per frame.
+ * The engine reads them once at the start of each frame, without blocking */
+const HgFileChange* hgGetFileChanges(
+  uint32_t* count  /* number of changes returned */
+);
+
+/* A file being read on a background thread */
+typedef struct HgFileLoad HgFileLoad;
+
+/* Called on the main thread when an async load finishes. data is null
+ * terminated and lives on the arena, it's NULL if the load failed */
+typedef void (*HgFileLoadCallback)(void* userData, char* data, size_t size);
+
+/* Read entire file on a background thread. Memory is pushed on the arena
+ * now, so only the main thread uses the arena. Don't pop that memory until
+ * the load is done. Finished loads are picked up at the start of a frame */
+HgFileLoad* hgLoadFileAsync(
+  HgArena* hgArena,             /* arena to push the file contents on */
+  const char* filepath,         /* filepath of file to load */
+  HgFileLoadCallback callback,  /* called when done, can be NULL */
+  void* userData                /* passed to callback */
+);
+
+/* Check if an async load is done. If it is, data and size are set */
+bool hgIsFileLoadDone(HgFileLoad* load, char** data, size_t* size);
+
+/* Block until every async load is done (i.e. behind a loading screen) */
+void hgWaitFileLoads(void);
+
 /****************
  * Mesh (02.03) *
  ****************/
@@ -173,6 +244,17 @@ typedef struct HgMesh HgMesh;
 /* cleans up mesh memory on gpu */
 void hgCleanupMesh(HgArena *hgArena, HgMesh *hgMesh);
 
+/* Most levels of detail a mesh has, the full mesh included */
+#define HG_MESH_MAX_LODS 5
+
+/* A level of detail, a simpler version of the mesh drawn when it's small on
+ * screen. It's a range of the mesh's indices, using the same vertices */
+typedef struct HgMeshLod {
+  uint32_t indStart;
+  uint32_t indCount;
+  float error; /* furthest it strays from the full mesh, over the diameter */
+}HgMeshLod;
+
 /******************
  * Camera (02.04) *
  ******************/
@@ -187,7 +269,8 @@ typedef struct HgCamera {
 typedef struct HgEntity{
   mat4 trans;
   HgMesh *mesh;
-  vec2 padding;
+  uint32_t lod; /* level of detail drawn last, see hgDrawEntity */
+  float padding;
 }HgEntity;
 
 void hgInitEntity(HgEntity *hgEntity, HgMesh *hgMesh);
@@ -219,6 +302,32 @@ HgMesh* hgLoadObjMesh(
 /* If fileName and objectName are the same */
 #define hgLoadMesh(a, b) hgLoadObjMesh(a, b, b)
 
+/* Every object in an obj file, see hgLoadObjFile */
+typedef struct HgObjFile {
+  uint32_t meshCount;
+  const char **names;  /* object names, in file order */
+  HgMesh **meshes;     /* same order as names */
+  uint32_t bucketCount;
+  uint32_t *buckets;   /* name lookup for hgObjFileMesh */
+}HgObjFile;
+
+/* Creates a mesh for every 'o' object in a wavefront obj file, parsing it
+ * (and its mtl file) once. Faces before the first 'o' are an object named
+ * fileName. Everything is pushed onto hgArena, NULL if it failed */
+HgObjFile* hgLoadObjFile(
+    HgArena *hgArena, /* Which arena to push the meshes and table onto */
+
+    const char* fileName /* name of obj file in res/modles folder
+                            (without .obj at end) */
+);
+
+/* The mesh for an object, NULL if the file has no object with that name */
+HgMesh* hgObjFileMesh(HgObjFile *hgObjFile, const char* objectName);
+
+/* cleans up the memory on gpu of every mesh in the file. The arena memory
+ * is freed by popping to before hgLoadObjFile */
+void hgCleanupObjFile(HgObjFile *hgObjFile);
+
 
 /******************
  * Shader (02.08) *
@@ -268,6 +377,27 @@ typedef struct HgVertex {
   vec2 texture;
 }HgVertex;
 
+/* HgVertex in half the bytes, made by hgCompactVertices */
+typedef struct HgCompactVertex {
+  uint16_t position[4]; /* 0-65535 across the mesh's bounds, w unused */
+  int8_t normal[4];     /* -127-127 is -1-1, w unused */
+  uint16_t texture[2];  /* half floats */
+}HgCompactVertex;
+
+/* Layouts a vertex buffer's verts can be in */
+#define HG_VERTEX_FLOAT 0   /* HgVertex */
+#define HG_VERTEX_COMPACT 1 /* HgCompactVertex */
+#define HG_VERTEX_LAYOUT_COUNT 2
+
+/* Bytes per vertex in layout */
+#define hgVertexSize(layout) \
+  (((layout) == HG_VERTEX_COMPACT) ? sizeof(HgCompactVertex) \
+                                   : sizeof(HgVertex))
+
+/* Bytes per index, the narrowest that can index vertCount verts */
+#define hgIndexSize(vertCount) \
+  (((vertCount) <= 65536) ? sizeof(uint16_t) : sizeof(uint32_t))
+
 /* Creates the vertexBuffer on a mesh. You don't have to do this manually,
  * in stead, look at "Load Wavefront obj" -- (02.07)*/
 void hgCreateMeshVertexBuffer(
@@ -277,11 +407,38 @@ void hgCreateMeshVertexBuffer(
 
     uint32_t vertCount, /* count of HgVertex in data buffer */
 
-    uint16_t* inds, /* buffer of indicies, order of verticies */
+    const void* inds, /* buffer of indicies, order of verticies */
+
+    uint32_t indCount, /* count of indices in inds */
 
-    uint32_t indCount /* count of indices in inds */
+    uint32_t indSize /* bytes per index, 2 (uint16_t) or 4 (uint32_t) */
 );
 
+/* hgCreateMeshVertexBuffer for verts in any layout */
+void hgCreateMeshVertexBufferEx(
+    HgMesh *hgMesh,
+
+    const void* data, /* verts in layout */
+
+    uint32_t layout, /* HG_VERTEX_FLOAT or HG_VERTEX_COMPACT */
+
+    uint32_t vertCount,
+
+    const void* inds,
+
+    uint32_t indCount,
+
+    uint32_t indSize,
+
+    const vec3 boundsMin, /* the bounds HG_VERTEX_COMPACT positions were */
+    const vec3 boundsMax  /* made across, and the LODs are picked by */
+);
+
+/* Give a mesh levels of detail, ranges of the indices it was created with.
+ * lods[0] is the full mesh, each one after is simpler. A mesh has only
+ * lods[0] until this is called */
+void hgSetMeshLods(HgMesh *hgMesh, const HgMeshLod *lods, uint32_t lodCount);
+
 /* Bind this vertex buffer for rendering geometry*/
 void hgBindVertexBuffer(HgVertexBuffer *vb, HgShader *s);
 
@@ -317,7 +474,9 @@ void hgCleanupTexture(HgTexture *t);
 /* Start the process of drawing this frame (i.e, clear the frame?)*/
 void hgBeginDraw(void);
 
-/* Draw an entity, with a lightsource, from camera's perspective */
+/* Draw an entity, with a lightsource, from camera's perspective. Meshes
+ * with levels of detail draw the simplest one that looks the same at the
+ * size the entity is on screen */
 void hgDrawEntity(HgEntity *hgEntity, HgLight *hgLight, HgCamera *hgCamera);
 
 
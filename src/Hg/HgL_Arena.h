@@ -58,6 +58,15 @@ HgArena* hgCreateArena(uint64_t initSize,
  *                   multiple of this number 
  *                   (for memory alignment). 
  *
+ *  Or create one with extra behaviour flags (see the
+ *  "Arena Flags" section below):
+ */
+
+HgArena* hgCreateArenaEx(uint64_t initSize,
+                         int memoryMultiple,
+                         uint32_t flags);
+
+/*
  *  Remember to destroy the HgArena when you are done with
  *  it!
  */
@@ -65,15 +74,54 @@ void hgDestroyArena(HgArena *hgArena);
 
 /*
  *  To allocate some memory, simply push it:
+ *
+ *  void* hgArenaPush(HgArena *hgArena, uint64_t allocSize);
  */
 
-void* hgArenaPush(HgArena *hgArena, uint64_t allocSize);
+#define hgArenaPush(a, s) \
+  hgl_arena_pushFunc((a), (s), 1, __FILE__, __LINE__)
 
 /*
  *   You can also clear out that memory before getting it:
+ *
+ *  void* hgArenaPushZero(HgArena *hgArena, uint64_t allocSize);
  */
 
-void* hgArenaPushZero(HgArena *hgArena, uint64_t allocSize);
+#define hgArenaPushZero(a, s) \
+  hgl_arena_pushZeroFunc((a), (s), 1, __FILE__, __LINE__)
+
+/*
+ *  Pushes only line up to the arena's memoryMultiple. If you
+ *  need a stronger alignment (SIMD data, cache lines, GPU
+ *  upload buffers), push it aligned. align must be a power
+ *  of 2:
+ *
+ *  void* hgArenaPushAligned(HgArena *hgArena,
+ *                           uint64_t allocSize,
+ *                           uint64_t align);
+ *
+ *  float *batch = hgArenaPushAligned(arena, size, 32);
+ *
+ *  (Pushes are macros as well, with HG_BUILD_DEBUG the arena
+ *  remembers the size and file/line of every push, and tells
+ *  you where the allocation on top came from when a pop is
+ *  wrong)
+ */
+
+#define hgArenaPushAligned(a, s, al) \
+  hgl_arena_pushFunc((a), (s), (al), __FILE__, __LINE__)
+
+void* hgl_arena_pushFunc(HgArena *arena,
+                         uint64_t allocSize,
+                         uint64_t align,
+                         const char *file,
+                         int line);
+
+void* hgl_arena_pushZeroFunc(HgArena *arena,
+                             uint64_t allocSize,
+                             uint64_t align,
+                             const char *file,
+                             int line);
 
 /*
  *  To "Free" the memory, just pop the pointer back to
@@ -86,19 +134,26 @@ void* hgArenaPushZero(HgArena *hgArena, uint64_t allocSize);
  *  line in your program that caused the error,
  *  not the location of hgl_arena_popFunc)
  *
- *  both pointer and size are needed, because pointer is
- *  used for safety checking, but when checking is not 
- *  enabled, memory size is used.
+ *  both pointer and size are needed. The arena rewinds to
+ *  the pointer (which also frees any alignment padding that
+ *  was added in front of it), and the size is used to check
+ *  that it really was the last allocation. With
+ *  HG_BUILD_DEBUG the pointer is also checked against a
+ *  stack of every pointer pushed.
  */
 #include <stdio.h>
 /* Include Hgl_Log.h before including this file for better logging */
 #ifndef HG_ERROR
-#define HG_ERROR(...) fprintf(stderr, ...);
+#define HG_ERROR(...) fprintf(stderr, __VA_ARGS__);
 #endif /* HG_ERROR */
+#ifndef HG_LOG
+#define HG_LOG(...) fprintf(stdout, __VA_ARGS__);
+#endif /* HG_LOG */
 
 #define  HGL_ARENA_NO_ALLOC 1
 #define  HGL_ARENA_WRONG_PTR 2
 #define  HGL_ARENA_WRONG_SIZE 3
+#define  HGL_ARENA_NO_COMMIT 4
 
 #define hgArenaPop(a, r, s) do {                    \
   switch(hgl_arena_popFunc((a), (r), (s))){         \
@@ -107,9 +162,11 @@ void* hgArenaPushZero(HgArena *hgArena, uint64_t allocSize);
       break;                                        \
     case(HGL_ARENA_WRONG_PTR):                      \
       HG_ERROR("Wrong pointer popped!");            \
+      hgl_arena_logTop((a));                        \
       break;                                        \
     case(HGL_ARENA_WRONG_SIZE):                     \
       HG_ERROR("Wrong size with associated ptr!");  \
+      hgl_arena_logTop((a));                        \
       break;                                        \
     default:                                        \
       break;                                        \
@@ -120,6 +177,9 @@ int hgl_arena_popFunc(HgArena *arena,
                       void *returnMemory,
                       uint64_t returnSize);
 
+/* Logs where the allocation on top of the arena was pushed */
+void hgl_arena_logTop(HgArena *arena);
+
 /*
  *  You can also completely clear an arena to be used 
  *  again. Useful in gamedev to have memory that only
@@ -129,6 +189,226 @@ int hgl_arena_popFunc(HgArena *arena,
 
 void hgArenaPopAll(HgArena *hgArena);
 
+/*
+ *  Temporary Memory:
+ *
+ *  Popping every allocation in reverse gets tedious when a
+ *  function needs several scratch buffers. Instead grab a
+ *  mark before pushing, and pop back to it when done. Every
+ *  allocation made after the mark is freed at once:
+ *
+ *  HgArenaMark mark = hgArenaGetMark(arena);
+ *  char *a = hgArenaPush(arena, aSize);
+ *  char *b = hgArenaPush(arena, bSize);
+ *  ...
+ *  hgArenaPopToMark(arena, mark);
+ */
+
+typedef struct HgArenaMark {
+  uint64_t position;
+  uint64_t ptrPosition; /* only used with HG_BUILD_DEBUG */
+}HgArenaMark;
+
+HgArenaMark hgArenaGetMark(HgArena *hgArena);
+
+void hgArenaPopToMark(HgArena *hgArena, HgArenaMark mark);
+
+/*
+ *  Arena Flags:
+ *
+ *  HGL_ARENA_VIRTUAL : Only reserve the address range of the
+ *      arena up front (mmap with no access), and commit real
+ *      pages in chunks as the arena grows. A huge arena then
+ *      costs nothing until it is used, and doesn't fail
+ *      under strict overcommit. When hgArenaPop or
+ *      hgArenaPopAll shrink the arena, pages above the
+ *      decommit threshold are given back to the OS.
+ *      On platforms without mmap this flag is ignored.
+ */
+
+#define HGL_ARENA_VIRTUAL (1 << 0)
+
+/*
+ *  HGL_ARENA_GROWABLE : Instead of failing when the arena is
+ *      full, a new block is added (at least initSize bytes, 
+ *      or bigger if the push needs it). Memory already pushed
+ *      never moves. Pops, marks and hgArenaPopAll work across
+ *      blocks, and empty blocks are freed again (one is kept
+ *      around so an arena that is cleared every frame doesn't
+ *      keep reallocating). Start small and let it grow.
+ *      Works with HGL_ARENA_VIRTUAL, new blocks are then
+ *      reserved and committed the same way.
+ */
+
+#define HGL_ARENA_GROWABLE (1 << 1)
+
+/*
+ *  HGL_ARENA_HUGE_PAGES : Back the arena with 2 MB pages, so a
+ *      big arena that is used all over doesn't thrash the TLB.
+ *      Uses MAP_HUGETLB if the system has huge pages set aside
+ *      (and the arena isn't HGL_ARENA_VIRTUAL, a huge page
+ *      reservation is taken from the pool up front), otherwise
+ *      transparent huge pages (madvise MADV_HUGEPAGE on a 2 MB
+ *      aligned range). Sizes
+ *      and commit chunks are rounded up to 2 MB.
+ *
+ *  HGL_ARENA_PREFAULT : Fault in the arena's pages when it is
+ *      created, so they aren't faulted in later (i.e: in the
+ *      middle of a frame). For HGL_ARENA_VIRTUAL arenas only
+ *      the memory up to the decommit threshold is prefaulted,
+ *      since that memory stays committed anyway.
+ */
+
+#define HGL_ARENA_HUGE_PAGES (1 << 2)
+#define HGL_ARENA_PREFAULT (1 << 3)
+
+/*
+ *  You can also prefault part of an arena yourself, after
+ *  setting the commit sizes:
+ */
+
+void hgArenaPrefault(HgArena *hgArena, uint64_t size);
+
+/*
+ *  The commit chunk and decommit threshold can be changed per
+ *  arena (both get rounded up to the page size):
+ *
+ *    commitChunk : how many bytes are committed at a time
+ *
+ *    decommitThreshold : how many bytes stay committed when
+ *                        the arena shrinks. Keeping some
+ *                        memory around stops an arena that
+ *                        is cleared every frame from
+ *                        faulting its pages back in.
+ */
+
+void hgArenaSetCommitSizes(HgArena *hgArena,
+                           uint64_t commitChunk,
+                           uint64_t decommitThreshold);
+
+/* Defaults, define before including to change them */
+#ifndef HGL_ARENA_RECORD_COUNT /* debug push records to start with */
+#define HGL_ARENA_RECORD_COUNT 1024
+#endif /* HGL_ARENA_RECORD_COUNT */
+
+#ifndef HGL_ARENA_COMMIT_CHUNK
+#define HGL_ARENA_COMMIT_CHUNK (1024 * 1024)
+#endif /* HGL_ARENA_COMMIT_CHUNK */
+
+#ifndef HGL_ARENA_HUGE_PAGE_SIZE
+#define HGL_ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif /* HGL_ARENA_HUGE_PAGE_SIZE */
+
+#ifndef HGL_ARENA_DECOMMIT_THRESHOLD
+#define HGL_ARENA_DECOMMIT_THRESHOLD (64 * 1024 * 1024)
+#endif /* HGL_ARENA_DECOMMIT_THRESHOLD */
+
+/*
+ *  Sharing an Arena Between Threads:
+ *
+ *  None of the functions above are thread safe. For memory
+ *  that is only ever added to from several threads (loading
+ *  assets, building per frame data), use the atomic pushes.
+ *  They are lock free, a compare and swap loop on the arena
+ *  position that only moves it once the push is known to fit.
+ *  A push that doesn't fit returns NULL and leaves the arena
+ *  as it was:
+ *
+ *  void* hgArenaPushAtomic(HgArena *hgArena, uint64_t allocSize);
+ *
+ *  void* hgArenaPushAtomicAligned(HgArena *hgArena,
+ *                                 uint64_t allocSize,
+ *                                 uint64_t align);
+ *
+ *  Atomic pushes can't be popped one at a time, and don't grow
+ *  HGL_ARENA_GROWABLE arenas (they fail once the current block
+ *  is full). Once every thread is done, free them all at once
+ *  with hgArenaPopToMark or hgArenaPopAll.
+ *
+ *  Each thread can also carve off its own sub arena, and then
+ *  use the normal (faster) functions on it without fighting
+ *  over the shared arena:
+ */
+
+#define hgArenaPushAtomic(a, s) \
+  hgl_arena_pushAtomicFunc((a), (s), 1)
+
+#define hgArenaPushAtomicAligned(a, s, al) \
+  hgl_arena_pushAtomicFunc((a), (s), (al))
+
+void* hgl_arena_pushAtomicFunc(HgArena *arena,
+                               uint64_t allocSize,
+                               uint64_t align);
+
+HgArena* hgCreateSubArena(HgArena *hgArena, uint64_t size);
+
+/*
+ *    hgArena : arena to carve the memory from (atomically)
+ *
+ *    size : size in bytes of the sub arena
+ *
+ *  Destroy the sub arena with hgDestroyArena when the thread
+ *  is done with it. Its memory goes back to the parent arena
+ *  when the parent is popped.
+ */
+
+/*
+ *  Stats:
+ *
+ *  With HGL_ARENA_STATS defined (on by default in
+ *  HG_BUILD_DEBUG builds) the arena keeps count of how it is
+ *  used. Memory can be tagged, every push after setting a
+ *  tag is counted under it until the tag changes. Tags must
+ *  be string literals (or otherwise outlive the arena).
+ *  hgArenaSetTag returns the old tag, so it can be put back:
+ *
+ *  const char *oldTag = hgArenaSetTag(arena, "mesh");
+ *  ...load a mesh...
+ *  hgArenaSetTag(arena, oldTag);
+ */
+
+const char* hgArenaSetTag(HgArena *hgArena, const char *tag);
+
+/* Max number of different tags reported, the rest go in otherBytes */
+#ifndef HGL_ARENA_MAX_TAGS
+#define HGL_ARENA_MAX_TAGS 16
+#endif /* HGL_ARENA_MAX_TAGS */
+
+typedef struct HgArenaTagStats {
+  const char *tag;
+  uint64_t bytes;     /* bytes currently pushed under this tag */
+}HgArenaTagStats;
+
+typedef struct HgArenaStats {
+  uint64_t used;      /* bytes currently pushed */
+  uint64_t reserved;  /* bytes of address space in all blocks */
+  uint64_t committed; /* bytes backed by memory */
+  uint64_t blocks;    /* blocks in a growable arena */
+
+  /* Only counted with HGL_ARENA_STATS */
+  uint64_t peak;         /* most bytes pushed at once */
+  uint64_t pushes;
+  uint64_t pops;         /* pops, pops to mark and pop alls */
+  uint64_t paddingBytes; /* total bytes lost to padding */
+  uint32_t tagCount;
+  HgArenaTagStats tags[HGL_ARENA_MAX_TAGS];
+  uint64_t otherBytes;   /* bytes under tags past the first MAX_TAGS */
+}HgArenaStats;
+
+HgArenaStats hgArenaGetStats(HgArena *hgArena);
+
+/* Print the stats of the arena to the log, under this name */
+void hgArenaLogStats(HgArena *hgArena, const char *name);
+
+/* Start measuring the peak again (i.e: each frame, or each level) */
+void hgArenaResetPeak(HgArena *hgArena);
+
+#ifdef HG_BUILD_DEBUG
+#ifndef HGL_ARENA_STATS
+#define HGL_ARENA_STATS
+#endif /* HGL_ARENA_STATS */
+#endif /* HG_BUILD_DEBUG */
+
 /*
  *  END OF DOCUMENTATION
  */
@@ -139,6 +419,43 @@ void hgArenaPopAll(HgArena *hgArena);
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdbool.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HGL_ARENA_HAS_MMAP
+/* POSIX */
+#include <sys/mman.h>
+#include <unistd.h>
+#endif /* __unix__ || __APPLE__ */
+
+/* Memory of sub arenas belongs to another arena */
+#define HGL_ARENA_SUB (1u << 31)
+
+/* Older, full blocks of a growable arena */
+typedef struct HgArenaBlock {
+  struct HgArenaBlock *prev;
+  uint8_t *memory;
+  uint64_t size;
+  uint64_t position;
+  uint64_t commitPosition;
+  uint64_t base;
+}HgArenaBlock;
+
+#ifdef HGL_ARENA_STATS
+typedef struct HgArenaTagRange {
+  const char *tag;
+  uint64_t start;
+}HgArenaTagRange;
+#endif /* HGL_ARENA_STATS */
+
+#ifdef HG_BUILD_DEBUG
+typedef struct HgArenaRecord {
+  void *ptr;
+  uint64_t size;
+  const char *file;
+  int line;
+}HgArenaRecord;
+#endif /*HG_BUILD_DEBUG*/
 
 struct HgArena {
   /* Data */
@@ -146,84 +463,532 @@ struct HgArena {
   uint64_t dataSize;
   uint64_t dataPosition;
   uint8_t dataMultiple;
+  uint32_t flags;
+  uint64_t maxAlignPadding; /* largest front padding of an aligned push */
+
+  /* Virtual memory, bytes of dataMemory that are backed by pages */
+  uint64_t commitPosition;
+  uint64_t commitChunk;
+  uint64_t decommitThreshold;
+
+  /* Growable arenas, dataMemory is the newest block */
+  HgArenaBlock *prevBlock;
+  uint64_t blockBase;   /* mark position of the start of dataMemory */
+  uint64_t blockSize;   /* smallest size of a new block */
+  uint8_t *spareMemory; /* one empty block kept around for reuse */
+  uint64_t spareSize;
+  uint64_t spareCommit;
+
+#ifdef HGL_ARENA_STATS
+  HgArenaStats stats;
+  const char *tag;
+  /* Tags of pushed memory, each from its start to the next one's */
+  uint64_t tagSize;
+  uint64_t tagPosition;
+  HgArenaTagRange *tagMemory;
+#endif /* HGL_ARENA_STATS */
   
 #ifdef HG_BUILD_DEBUG
-  /* Pointer check memory */
+  /* Pointer check memory, a stack of every push */
   uint64_t ptrSize;
   uint64_t ptrPosition;
-  void** ptrMemory;
+  HgArenaRecord *ptrMemory;
 #endif /*HG_BUILD_DEBUG*/
 };
 
+uint64_t hgl_arena_roundUp(uint64_t value, uint64_t multiple){
+  if(value % multiple != 0){
+    value += multiple - (value % multiple);
+  }
+  return value;
+}
+
 HgArena* hgCreateArena(uint64_t initSize, int memMultiple){
+  return hgCreateArenaEx(initSize, memMultiple, 0);
+}
+
+/* Get a new block of memory for the arena, sets the dataMemory,
+ * dataSize and commitPosition of the arena. */
+#ifdef HGL_ARENA_HAS_MMAP
+/* Page size the arena commits and decommits in */
+uint64_t hgl_arena_pageSize(HgArena *arena){
+  if(arena->flags & HGL_ARENA_HUGE_PAGES){
+    return HGL_ARENA_HUGE_PAGE_SIZE;
+  }
+  return sysconf(_SC_PAGESIZE);
+}
+
+/* mmap a range that starts on an align boundary, so transparent
+ * huge pages can back all of it */
+void* hgl_arena_mapAligned(uint64_t size, int prot, int mapFlags,
+                           uint64_t align){
+  uint8_t *mapped = (uint8_t*)mmap(NULL, size + align, prot, mapFlags, -1, 0);
+  if((void*)mapped == MAP_FAILED){
+    return MAP_FAILED;
+  }
+  uint8_t *aligned = (uint8_t*)(((uintptr_t)mapped + (align - 1))
+                                & ~(uintptr_t)(align - 1));
+  if(aligned > mapped){
+    munmap(mapped, aligned - mapped);
+  }
+  if(aligned + size < mapped + size + align){
+    munmap(aligned + size, (mapped + size + align) - (aligned + size));
+  }
+  return aligned;
+}
+#endif /* HGL_ARENA_HAS_MMAP */
+
+/* Get a new block of memory for the arena, sets the dataMemory,
+ * dataSize and commitPosition of the arena. */
+int hgl_arena_allocBlock(HgArena *arena, uint64_t size){
+#ifdef HGL_ARENA_HAS_MMAP
+  if(arena->flags & (HGL_ARENA_VIRTUAL | HGL_ARENA_HUGE_PAGES)){
+    size = hgl_arena_roundUp(size, hgl_arena_pageSize(arena));
+
+    /* Virtual arenas reserve now and commit later */
+    int prot = (arena->flags & HGL_ARENA_VIRTUAL)
+               ? PROT_NONE : PROT_READ | PROT_WRITE;
+    int mapFlags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+    void *reserved = MAP_FAILED;
+
+    if(arena->flags & HGL_ARENA_HUGE_PAGES){
+#ifdef MAP_HUGETLB
+      /* No MAP_NORESERVE here, so this fails (instead of SIGBUS on
+       * first touch) if there aren't enough huge pages set aside. That
+       * takes the whole size from the pool now, so virtual arenas, which
+       * reserve far more than they use, stick to transparent huge pages */
+      if(!(arena->flags & HGL_ARENA_VIRTUAL)){
+        reserved = mmap(NULL,
+                        size,
+                        prot,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                        -1,
+                        0);
+      }
+#endif /* MAP_HUGETLB */
+      if(reserved == MAP_FAILED){
+        reserved = hgl_arena_mapAligned(size,
+                                        prot,
+                                        mapFlags,
+                                        HGL_ARENA_HUGE_PAGE_SIZE);
+#ifdef MADV_HUGEPAGE
+        if(reserved != MAP_FAILED){
+          madvise(reserved, size, MADV_HUGEPAGE);
+        }
+#endif /* MADV_HUGEPAGE */
+      }
+    }else{
+      reserved = mmap(NULL, size, prot, mapFlags, -1, 0);
+    }
+
+    if(reserved == MAP_FAILED){
+      return HGL_ARENA_NO_COMMIT;
+    }
+    arena->dataMemory = (uint8_t*)reserved;
+    arena->dataSize = size;
+    arena->commitPosition = (arena->flags & HGL_ARENA_VIRTUAL) ? 0 : size;
+    return 0;
+  }
+#endif /* HGL_ARENA_HAS_MMAP */
+
+  uint8_t *memory = (uint8_t*)malloc(size);
+  if(memory == NULL){
+    return HGL_ARENA_NO_COMMIT;
+  }
+  arena->dataMemory = memory;
+  arena->dataSize = size;
+  /* malloc'd memory is always committed */
+  arena->commitPosition = size;
+  return 0;
+}
+
+void hgl_arena_freeBlock(HgArena *arena, uint8_t *memory, uint64_t size){
+  if(arena->flags & HGL_ARENA_SUB){
+    return;
+  }
+#ifdef HGL_ARENA_HAS_MMAP
+  if(arena->flags & (HGL_ARENA_VIRTUAL | HGL_ARENA_HUGE_PAGES)){
+    munmap(memory, size);
+    return;
+  }
+#endif /* HGL_ARENA_HAS_MMAP */
+  (void)(size);
+  free(memory);
+}
+
+/* Sets up a new arena. If memory is not NULL, the arena uses it instead
+ * of getting its own block. */
+HgArena* hgl_arena_create(uint64_t initSize,
+                          int memMultiple,
+                          uint32_t flags,
+                          uint8_t *memory){
   HgArena* arena = (HgArena*)malloc(sizeof(HgArena));
-  arena->dataMultiple = memMultiple;
   if(arena == NULL){
     HG_ERROR("Out of Memory, Can't make new HgArena!");
     return NULL;
   }
 
-  arena->dataSize = initSize;
+  arena->dataMultiple = memMultiple;
+  arena->flags = flags;
   arena->dataPosition = 0;
-  arena->dataMemory = (uint8_t*)malloc(arena->dataSize); 
-  if(arena->dataMemory == NULL){
+  arena->maxAlignPadding = 0;
+
+  arena->prevBlock = NULL;
+  arena->blockBase = 0;
+  arena->blockSize = initSize;
+  arena->spareMemory = NULL;
+  arena->spareSize = 0;
+  arena->spareCommit = 0;
+
+#ifdef HGL_ARENA_STATS
+  memset(&arena->stats, 0, sizeof(HgArenaStats));
+  arena->tag = "untagged";
+  arena->tagSize = 0;
+  arena->tagPosition = 0;
+  arena->tagMemory = NULL;
+#endif /* HGL_ARENA_STATS */
+
+#ifndef HGL_ARENA_HAS_MMAP
+  arena->flags &= ~(HGL_ARENA_VIRTUAL | HGL_ARENA_HUGE_PAGES);
+#endif /* HGL_ARENA_HAS_MMAP */
+
+  if(memory != NULL){
+    arena->dataMemory = memory;
+    arena->dataSize = initSize;
+    arena->commitPosition = initSize;
+  }else if(hgl_arena_allocBlock(arena, initSize)){
     HG_ERROR("Out of Memory, Can't make HgArena Data Memory!");
-      free(arena);
-      return NULL;
+    free(arena);
+    return NULL;
+  }
+
+  if(arena->flags & HGL_ARENA_VIRTUAL){
+    hgArenaSetCommitSizes(arena,
+                          HGL_ARENA_COMMIT_CHUNK,
+                          HGL_ARENA_DECOMMIT_THRESHOLD);
+  }else{
+    arena->commitChunk = arena->dataSize;
+    arena->decommitThreshold = arena->dataSize;
   }
   
 #ifdef HG_BUILD_DEBUG
-  arena->ptrSize = sizeof(void*) * 20;
+  arena->ptrSize = HGL_ARENA_RECORD_COUNT;
   arena->ptrPosition = 0;
-  arena->ptrMemory = (void**)malloc(arena->ptrSize); 
+  arena->ptrMemory = (HgArenaRecord*)malloc(arena->ptrSize
+                                            * sizeof(HgArenaRecord));
   if(arena->ptrMemory == NULL){
     HG_ERROR("Out of Memory, Can't make HgArena Pointer Memory!");
-      free(arena);
-      free(arena ->dataMemory);
-      return NULL;
+    arena->ptrSize = 0;
+    hgDestroyArena(arena);
+    return NULL;
   }
 #endif /*HG_BUILD_DEBUG*/
+
+  if(arena->flags & HGL_ARENA_PREFAULT){
+    hgArenaPrefault(arena,
+                    (arena->flags & HGL_ARENA_VIRTUAL)
+                    ? arena->decommitThreshold : arena->dataSize);
+  }
   return arena;
 }
 
+HgArena* hgCreateArenaEx(uint64_t initSize,
+                         int memMultiple,
+                         uint32_t flags){
+  return hgl_arena_create(initSize, memMultiple, flags & ~HGL_ARENA_SUB, NULL);
+}
+
+HgArena* hgCreateSubArena(HgArena *parent, uint64_t size){
+  /* cache line aligned, so threads don't share lines at the edges */
+  uint8_t *memory = (uint8_t*)hgl_arena_pushAtomicFunc(parent, size, 64);
+  if(memory == NULL){
+    HG_ERROR("Out of Memory, Can't carve a sub arena!");
+    return NULL;
+  }
+  return hgl_arena_create(size, parent->dataMultiple, HGL_ARENA_SUB, memory);
+}
+
 void hgDestroyArena(HgArena *arena){
  
-  free(arena->dataMemory);
+  hgl_arena_freeBlock(arena, arena->dataMemory, arena->dataSize);
+  while(arena->prevBlock != NULL){
+    HgArenaBlock *block = arena->prevBlock;
+    arena->prevBlock = block->prev;
+    hgl_arena_freeBlock(arena, block->memory, block->size);
+    free(block);
+  }
+  if(arena->spareMemory != NULL){
+    hgl_arena_freeBlock(arena, arena->spareMemory, arena->spareSize);
+  }
+#ifdef HGL_ARENA_STATS
+  free(arena->tagMemory);
+#endif /* HGL_ARENA_STATS */
 #ifdef HG_BUILD_DEBUG
   free(arena->ptrMemory);
 #endif
   free(arena);
 }
 
-void* hgArenaPush(HgArena *arena, uint64_t allocSize){
+/* Growable arenas: move on to a new block with room for minSize */
+int hgl_arena_nextBlock(HgArena *arena, uint64_t minSize){
+  HgArenaBlock *block = (HgArenaBlock*)malloc(sizeof(HgArenaBlock));
+  if(block == NULL){
+    return HGL_ARENA_NO_COMMIT;
+  }
+  block->prev = arena->prevBlock;
+  block->memory = arena->dataMemory;
+  block->size = arena->dataSize;
+  block->position = arena->dataPosition;
+  block->commitPosition = arena->commitPosition;
+  block->base = arena->blockBase;
+
+  if(arena->spareMemory != NULL && arena->spareSize >= minSize){
+    arena->dataMemory = arena->spareMemory;
+    arena->dataSize = arena->spareSize;
+    arena->commitPosition = arena->spareCommit;
+    arena->spareMemory = NULL;
+  }else{
+    uint64_t size = minSize > arena->blockSize ? minSize : arena->blockSize;
+    if(hgl_arena_allocBlock(arena, size)){
+      /* current block was not touched */
+      free(block);
+      return HGL_ARENA_NO_COMMIT;
+    }
+  }
+
+  arena->prevBlock = block;
+  arena->blockBase = block->base + block->size;
+  arena->dataPosition = 0;
+  return 0;
+}
+
+/* Growable arenas: drop the newest (empty) block, and go back to the
+ * one before it. The dropped block is kept as the spare if there is
+ * none yet. */
+void hgl_arena_prevBlock(HgArena *arena){
+  HgArenaBlock *block = arena->prevBlock;
+
+  if(arena->spareMemory == NULL){
+    arena->spareMemory = arena->dataMemory;
+    arena->spareSize = arena->dataSize;
+    arena->spareCommit = arena->commitPosition;
+  }else{
+    hgl_arena_freeBlock(arena, arena->dataMemory, arena->dataSize);
+  }
+
+  arena->dataMemory = block->memory;
+  arena->dataSize = block->size;
+  arena->dataPosition = block->position;
+  arena->commitPosition = block->commitPosition;
+  arena->blockBase = block->base;
+  arena->prevBlock = block->prev;
+  free(block);
+}
+
+void hgArenaSetCommitSizes(HgArena *arena,
+                           uint64_t commitChunk,
+                           uint64_t decommitThreshold){
+  if(!(arena->flags & HGL_ARENA_VIRTUAL)){
+    return;
+  }
+#ifdef HGL_ARENA_HAS_MMAP
+  uint64_t pageSize = hgl_arena_pageSize(arena);
+  if(commitChunk == 0){
+    commitChunk = pageSize;
+  }
+  arena->commitChunk = hgl_arena_roundUp(commitChunk, pageSize);
+  arena->decommitThreshold = hgl_arena_roundUp(decommitThreshold,
+                                               arena->commitChunk);
+#else
+  (void)(commitChunk);
+  (void)(decommitThreshold);
+#endif /* HGL_ARENA_HAS_MMAP */
+}
+
+/* Make sure memory up to position is backed by pages */
+int hgl_arena_commit(HgArena *arena, uint64_t position){
+  if(position <= arena->commitPosition){
+    return 0;
+  }
+#ifdef HGL_ARENA_HAS_MMAP
+  uint64_t newCommit = hgl_arena_roundUp(position, arena->commitChunk);
+  if(newCommit > arena->dataSize){
+    newCommit = arena->dataSize;
+  }
+
+  if(mprotect(arena->dataMemory + arena->commitPosition,
+              newCommit - arena->commitPosition,
+              PROT_READ | PROT_WRITE) != 0){
+    return HGL_ARENA_NO_COMMIT;
+  }
+  arena->commitPosition = newCommit;
+  return 0;
+#else
+  return HGL_ARENA_NO_COMMIT;
+#endif /* HGL_ARENA_HAS_MMAP */
+}
+
+void hgArenaPrefault(HgArena *arena, uint64_t size){
+  if(size > arena->dataSize){
+    size = arena->dataSize;
+  }
+  if(hgl_arena_commit(arena, size)){
+    HG_ERROR("Arena Prefault FAILED! Can't commit memory!");
+    return;
+  }
+
+#ifdef HGL_ARENA_HAS_MMAP
+#ifdef MADV_POPULATE_WRITE
+  if(madvise(arena->dataMemory, size, MADV_POPULATE_WRITE) == 0){
+    return;
+  }
+#endif /* MADV_POPULATE_WRITE */
+  uint64_t pageSize = sysconf(_SC_PAGESIZE);
+#else
+  uint64_t pageSize = 4096;
+#endif /* HGL_ARENA_HAS_MMAP */
+
+  /* Touch every page, without changing memory already in use */
+  volatile uint8_t *memory = arena->dataMemory;
+  for(uint64_t i = 0; i < size; i += pageSize){
+    memory[i] = memory[i];
+  }
+}
+
+/* Give pages above the decommit threshold back to the OS */
+void hgl_arena_decommit(HgArena *arena){
+  if(!(arena->flags & HGL_ARENA_VIRTUAL)){
+    return;
+  }
+#ifdef HGL_ARENA_HAS_MMAP
+  uint64_t keep = hgl_arena_roundUp(arena->dataPosition, arena->commitChunk);
+  if(keep < arena->decommitThreshold){
+    keep = arena->decommitThreshold;
+  }
+  if(keep >= arena->commitPosition){
+    return;
+  }
+
+  uint64_t releaseSize = arena->commitPosition - keep;
+  madvise(arena->dataMemory + keep, releaseSize, MADV_DONTNEED);
+  mprotect(arena->dataMemory + keep, releaseSize, PROT_NONE);
+  arena->commitPosition = keep;
+#endif /* HGL_ARENA_HAS_MMAP */
+}
+
+#ifdef HGL_ARENA_STATS
+/* Count a push that started at position (in the current block) */
+void hgl_arena_statsPush(HgArena *arena,
+                         uint64_t position,
+                         uint64_t paddingBytes){
+  uint64_t start = arena->blockBase + position;
+  uint64_t used = arena->blockBase + arena->dataPosition;
+
+  arena->stats.pushes++;
+  arena->stats.paddingBytes += paddingBytes;
+  if(used > arena->stats.peak){
+    arena->stats.peak = used;
+  }
+
+  if(arena->tagPosition > 0
+     && arena->tagMemory[arena->tagPosition - 1].tag == arena->tag){
+    return;
+  }
+
+  if(arena->tagPosition == arena->tagSize){
+    uint64_t newSize = arena->tagSize ? arena->tagSize * 2 : 16;
+    HgArenaTagRange *newMemory = (HgArenaTagRange*)realloc(
+        arena->tagMemory, newSize * sizeof(HgArenaTagRange));
+    if(newMemory == NULL){
+      return;
+    }
+    arena->tagMemory = newMemory;
+    arena->tagSize = newSize;
+  }
+  arena->tagMemory[arena->tagPosition].tag = arena->tag;
+  arena->tagMemory[arena->tagPosition].start = start;
+  arena->tagPosition++;
+}
+
+/* Count a pop, and forget tag ranges that were popped */
+void hgl_arena_statsPop(HgArena *arena){
+  uint64_t used = arena->blockBase + arena->dataPosition;
+
+  arena->stats.pops++;
+  while(arena->tagPosition > 0
+        && arena->tagMemory[arena->tagPosition - 1].start >= used){
+    arena->tagPosition--;
+  }
+}
+#endif /* HGL_ARENA_STATS */
+
+void* hgl_arena_pushFunc(HgArena *arena,
+                         uint64_t allocSize,
+                         uint64_t align,
+                         const char *file,
+                         int line){
+  if(align == 0 || (align & (align - 1)) != 0){
+    HG_ERROR("Arena Alloc FAILED! Alignment must be a power of 2!");
+    return NULL;
+  }
+
   /* calc alignment */
-  uint64_t allocPadded = allocSize;
-  if(allocPadded % arena->dataMultiple != 0){
-    allocPadded += arena->dataMultiple 
-      - (allocPadded % arena->dataMultiple);
+  uint64_t allocPadded = hgl_arena_roundUp(allocSize, arena->dataMultiple);
+
+  /* padding in front, so the start address is aligned */
+  uintptr_t top = (uintptr_t)(arena->dataMemory + arena->dataPosition);
+  uint64_t alignPadding = ((top + (align - 1)) & ~(uintptr_t)(align - 1))
+                          - top;
+  uint64_t newPosition = arena->dataPosition + alignPadding + allocPadded;
+
+  if(newPosition > arena->dataSize){
+    if(!(arena->flags & HGL_ARENA_GROWABLE)
+       || hgl_arena_nextBlock(arena, allocPadded + align)){
+      HG_ERROR("Arena Alloc FAILED! Out of memory!");
+      return NULL;
+    }
+    top = (uintptr_t)arena->dataMemory;
+    alignPadding = ((top + (align - 1)) & ~(uintptr_t)(align - 1)) - top;
+    newPosition = alignPadding + allocPadded;
   }
 
-  if(arena->dataPosition + allocPadded > arena->dataSize){
-    HG_ERROR("Arena Alloc FAILED! Out of memory!");
+  if(hgl_arena_commit(arena, newPosition)){
+    HG_ERROR("Arena Alloc FAILED! Can't commit memory!");
     return NULL;
   }
 #ifdef HG_BUILD_DEBUG
-  if(arena->ptrPosition + sizeof(void*) > arena->ptrSize){
-    void** newMemory = (void**)realloc(arena->ptrMemory,
-                                       arena->ptrSize * 1.5);
+  if(arena->ptrPosition == arena->ptrSize){
+    /* Double it, so pushing stays O(1) (amortized) */
+    HgArenaRecord* newMemory = (HgArenaRecord*)realloc(
+        arena->ptrMemory, arena->ptrSize * 2 * sizeof(HgArenaRecord));
     if(newMemory == NULL){
     HG_ERROR("Arena Alloc FAILED! Out of memory!");
     return NULL; 
     }
     arena->ptrMemory = newMemory;
+    arena->ptrSize *= 2;
   }
+#else
+  (void)(file);
+  (void)(line);
 #endif /*HG_BUILD_DEBUG*/
-  uint64_t oldPosition = arena->dataPosition;
-  arena->dataPosition += allocPadded;
-  void* ptr = arena->dataMemory + oldPosition;
+  void* ptr = arena->dataMemory + arena->dataPosition + alignPadding;
+  arena->dataPosition = newPosition;
+  if(alignPadding > arena->maxAlignPadding){
+    arena->maxAlignPadding = alignPadding;
+  }
+#ifdef HGL_ARENA_STATS
+  hgl_arena_statsPush(arena,
+                      (uint8_t*)ptr - arena->dataMemory - alignPadding,
+                      alignPadding + allocPadded - allocSize);
+#endif /* HGL_ARENA_STATS */
  
 #ifdef HG_BUILD_DEBUG
-  arena->ptrMemory[arena->ptrPosition] = ptr;
+  HgArenaRecord *record = &arena->ptrMemory[arena->ptrPosition];
+  record->ptr = ptr;
+  record->size = allocSize;
+  record->file = file;
+  record->line = line;
   arena->ptrPosition++;
 #endif /*HG_BUILD_DEBUG*/
 
@@ -231,9 +996,104 @@ void* hgArenaPush(HgArena *arena, uint64_t allocSize){
 
 }
 
-void* hgArenaPushZero(HgArena *arena, uint64_t allocSize){
-  void* memory = hgArenaPush(arena, allocSize);
-  memset(memory, 0, allocSize);
+/* hgl_arena_commit, safe to call from several threads at once. Two
+ * threads can mprotect the same pages, that is harmless. */
+int hgl_arena_commitAtomic(HgArena *arena, uint64_t position){
+  uint64_t commit = __atomic_load_n(&arena->commitPosition, __ATOMIC_ACQUIRE);
+  while(position > commit){
+#ifdef HGL_ARENA_HAS_MMAP
+    uint64_t newCommit = hgl_arena_roundUp(position, arena->commitChunk);
+    if(newCommit > arena->dataSize){
+      newCommit = arena->dataSize;
+    }
+    if(mprotect(arena->dataMemory + commit,
+                newCommit - commit,
+                PROT_READ | PROT_WRITE) != 0){
+      return HGL_ARENA_NO_COMMIT;
+    }
+    /* on failure commit is reloaded, and we check again */
+    if(__atomic_compare_exchange_n(&arena->commitPosition,
+                                   &commit,
+                                   newCommit,
+                                   false,
+                                   __ATOMIC_ACQ_REL,
+                                   __ATOMIC_ACQUIRE)){
+      break;
+    }
+#else
+    return HGL_ARENA_NO_COMMIT;
+#endif /* HGL_ARENA_HAS_MMAP */
+  }
+  return 0;
+}
+
+void* hgl_arena_pushAtomicFunc(HgArena *arena,
+                               uint64_t allocSize,
+                               uint64_t align){
+  if(align == 0 || (align & (align - 1)) != 0){
+    HG_ERROR("Atomic Arena Alloc FAILED! Alignment must be a power of 2!");
+    return NULL;
+  }
+
+  uint64_t allocPadded = hgl_arena_roundUp(allocSize, arena->dataMultiple);
+
+  /* Only move the position once the push is known to fit, so a failed
+   * push leaves the arena as it was. On a lost race start is reloaded,
+   * and the padding worked out again */
+  uint64_t start = __atomic_load_n(&arena->dataPosition, __ATOMIC_RELAXED);
+  uint64_t reserveSize;
+  do{
+    uintptr_t top = (uintptr_t)(arena->dataMemory + start);
+    uint64_t alignPadding = ((top + (align - 1)) & ~(uintptr_t)(align - 1))
+                            - top;
+    reserveSize = alignPadding + allocPadded;
+    if(start + reserveSize > arena->dataSize){
+      HG_ERROR("Atomic Arena Alloc FAILED! Out of memory!");
+      return NULL;
+    }
+  }while(!__atomic_compare_exchange_n(&arena->dataPosition,
+                                      &start,
+                                      start + reserveSize,
+                                      true,
+                                      __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED));
+
+  if(hgl_arena_commitAtomic(arena, start + reserveSize)){
+    HG_ERROR("Atomic Arena Alloc FAILED! Can't commit memory!");
+    return NULL;
+  }
+
+  void *ptr = arena->dataMemory + start + (reserveSize - allocPadded);
+
+#ifdef HGL_ARENA_STATS
+  uint64_t used = arena->blockBase + start + reserveSize;
+  uint64_t peak = __atomic_load_n(&arena->stats.peak, __ATOMIC_RELAXED);
+  while(used > peak
+        && !__atomic_compare_exchange_n(&arena->stats.peak,
+                                        &peak,
+                                        used,
+                                        false,
+                                        __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)){
+  }
+  __atomic_fetch_add(&arena->stats.pushes, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&arena->stats.paddingBytes,
+                     reserveSize - allocSize,
+                     __ATOMIC_RELAXED);
+#endif /* HGL_ARENA_STATS */
+
+  return ptr;
+}
+
+void* hgl_arena_pushZeroFunc(HgArena *arena,
+                             uint64_t allocSize,
+                             uint64_t align,
+                             const char *file,
+                             int line){
+  void* memory = hgl_arena_pushFunc(arena, allocSize, align, file, line);
+  if(memory != NULL){
+    memset(memory, 0, allocSize);
+  }
   return memory;
 }
 
@@ -247,54 +1107,212 @@ int hgl_arena_popFunc(HgArena *arena,
     return HGL_ARENA_NO_ALLOC;
   }
 
-  void* peek = arena->ptrMemory[arena->ptrPosition - 1];
-  if(returnMemory == peek){
-    
-    uint64_t dataMemSize = (uint64_t)arena->dataMemory
-                    + (uint64_t)arena->dataPosition 
-                    - (uint64_t)returnMemory;
-    /* calc alignment */
-    uint64_t returnPadded = returnSize;
-    if(returnPadded % arena->dataMultiple != 0){
-      returnPadded += arena->dataMultiple 
-        - (returnPadded % arena->dataMultiple);
-    }
-
-    if(returnPadded != dataMemSize){
-      return HGL_ARENA_WRONG_SIZE;
-    }
-
-    arena->dataPosition = (uint64_t)returnMemory 
-                          - (uint64_t)arena->dataMemory;
-
-    arena->ptrPosition--;
-    return 0;
-  }else{
+  void* peek = arena->ptrMemory[arena->ptrPosition - 1].ptr;
+  if(returnMemory != peek){
     return HGL_ARENA_WRONG_PTR;
   }
-#else
+#endif /*HG_BUILD_DEBUG*/
 
-  (void)(returnMemory);
   /* calc alignment */
-  uint64_t returnPadded = returnSize;
-  if(returnPadded % arena->dataMultiple != 0){
-    returnPadded += arena->dataMultiple 
-      - (returnPadded % arena->dataMultiple);
+  uint64_t returnPadded = hgl_arena_roundUp(returnSize, arena->dataMultiple);
+
+  /* The allocation must end at the top of the arena, or just below
+   * the front padding left over from a popped aligned push. Padding
+   * in front of this allocation is freed when the one below it is. */
+  uint8_t *returnPtr = (uint8_t*)returnMemory;
+
+  /* Growable arenas, go back a block once the newest one is empty */
+  while(arena->prevBlock != NULL
+        && arena->dataPosition <= arena->maxAlignPadding
+        && (returnPtr < arena->dataMemory
+            || returnPtr >= arena->dataMemory + arena->dataSize)){
+    hgl_arena_prevBlock(arena);
   }
 
-  if(arena->dataPosition < returnPadded){
+  uint8_t *top = arena->dataMemory + arena->dataPosition;
+  if(returnPtr < arena->dataMemory
+     || returnPtr + returnPadded > top){
     return HGL_ARENA_WRONG_SIZE;
   }
+#ifdef HG_BUILD_DEBUG
+  /* The push's own size is known, so check against it, not the slack any
+   * aligned push in the arena could have left */
+  HgArenaRecord *record = &arena->ptrMemory[arena->ptrPosition - 1];
+  if(returnPadded != hgl_arena_roundUp(record->size, arena->dataMultiple)){
+    return HGL_ARENA_WRONG_SIZE;
+  }
+#else
+  if((uint64_t)(top - (returnPtr + returnPadded)) > arena->maxAlignPadding){
+    return HGL_ARENA_WRONG_SIZE;
+  }
+#endif /*HG_BUILD_DEBUG*/
+
+  arena->dataPosition = returnPtr - arena->dataMemory;
 
-  arena->dataPosition -= returnPadded;
+#ifdef HG_BUILD_DEBUG
+  arena->ptrPosition--;
+#endif /*HG_BUILD_DEBUG*/
+  hgl_arena_decommit(arena);
+#ifdef HGL_ARENA_STATS
+  hgl_arena_statsPop(arena);
+#endif /* HGL_ARENA_STATS */
 
   return 0;
+}
 
+void hgl_arena_logTop(HgArena *arena){
+#ifdef HG_BUILD_DEBUG
+  if(arena->ptrPosition == 0){
+    return;
+  }
+  HgArenaRecord *record = &arena->ptrMemory[arena->ptrPosition - 1];
+  HG_ERROR("Top of arena is %llu bytes at %p, pushed at %s %d",
+           (unsigned long long)record->size,
+           record->ptr,
+           record->file,
+           record->line);
+#else
+  (void)(arena);
+#endif /*HG_BUILD_DEBUG*/
+}
+
+HgArenaMark hgArenaGetMark(HgArena *arena){
+  HgArenaMark mark = {0};
+  mark.position = arena->blockBase + arena->dataPosition;
+#ifdef HG_BUILD_DEBUG
+  mark.ptrPosition = arena->ptrPosition;
 #endif /*HG_BUILD_DEBUG*/
+  return mark;
+}
+
+void hgArenaPopToMark(HgArena *arena, HgArenaMark mark){
+  if(mark.position > arena->blockBase + arena->dataPosition){
+    HG_ERROR("Arena mark is past the end of the arena!");
+    return;
+  }
+  while(mark.position < arena->blockBase){
+    hgl_arena_prevBlock(arena);
+  }
+  arena->dataPosition = mark.position - arena->blockBase;
+#ifdef HG_BUILD_DEBUG
+  arena->ptrPosition = mark.ptrPosition;
+#endif /*HG_BUILD_DEBUG*/
+  hgl_arena_decommit(arena);
+#ifdef HGL_ARENA_STATS
+  hgl_arena_statsPop(arena);
+#endif /* HGL_ARENA_STATS */
 }
 
 void hgArenaPopAll(HgArena *arena){
+  while(arena->prevBlock != NULL){
+    hgl_arena_prevBlock(arena);
+  }
   arena->dataPosition = 0;
+#ifdef HG_BUILD_DEBUG
+  arena->ptrPosition = 0;
+#endif /*HG_BUILD_DEBUG*/
+  hgl_arena_decommit(arena);
+#ifdef HGL_ARENA_STATS
+  hgl_arena_statsPop(arena);
+#endif /* HGL_ARENA_STATS */
+}
+
+
+const char* hgArenaSetTag(HgArena *arena, const char *tag){
+#ifdef HGL_ARENA_STATS
+  const char *oldTag = arena->tag;
+  arena->tag = tag;
+  return oldTag;
+#else
+  (void)(arena);
+  (void)(tag);
+  return NULL;
+#endif /* HGL_ARENA_STATS */
+}
+
+HgArenaStats hgArenaGetStats(HgArena *arena){
+  HgArenaStats stats = {0};
+#ifdef HGL_ARENA_STATS
+  stats = arena->stats;
+  stats.tagCount = 0;
+
+  /* Add up the tag ranges, newest first */
+  uint64_t end = arena->blockBase + arena->dataPosition;
+  for(uint64_t i = arena->tagPosition; i > 0; i--){
+    HgArenaTagRange *range = &arena->tagMemory[i - 1];
+
+    uint32_t t = 0;
+    while(t < stats.tagCount && strcmp(stats.tags[t].tag, range->tag) != 0){
+      t++;
+    }
+    if(t == stats.tagCount && stats.tagCount < HGL_ARENA_MAX_TAGS){
+      stats.tagCount++;
+      stats.tags[t].tag = range->tag;
+      stats.tags[t].bytes = 0;
+    }
+    /* out of slots, the tags already counted keep theirs */
+    if(t < stats.tagCount){
+      stats.tags[t].bytes += end - range->start;
+    }else{
+      stats.otherBytes += end - range->start;
+    }
+    end = range->start;
+  }
+#endif /* HGL_ARENA_STATS */
+
+  stats.used = arena->blockBase + arena->dataPosition;
+  stats.reserved = arena->dataSize;
+  stats.committed = arena->commitPosition;
+  stats.blocks = 1;
+  for(HgArenaBlock *block = arena->prevBlock; block; block = block->prev){
+    stats.reserved += block->size;
+    stats.committed += block->commitPosition;
+    stats.blocks++;
+  }
+  return stats;
+}
+
+void hgArenaLogStats(HgArena *arena, const char *name){
+  HgArenaStats stats = hgArenaGetStats(arena);
+  (void)(stats); /* HG_LOG can be compiled out */
+  (void)(name);
+
+  HG_LOG("Arena %s: %.1f KB used, %.1f KB committed, "
+         "%.1f KB reserved in %llu block(s)",
+         name,
+         stats.used / 1024.0,
+         stats.committed / 1024.0,
+         stats.reserved / 1024.0,
+         (unsigned long long)stats.blocks);
+#ifdef HGL_ARENA_STATS
+  HG_LOG("Arena %s: %.1f KB peak, %llu pushes, %llu pops, "
+         "%llu bytes padding",
+         name,
+         stats.peak / 1024.0,
+         (unsigned long long)stats.pushes,
+         (unsigned long long)stats.pops,
+         (unsigned long long)stats.paddingBytes);
+  for(uint32_t i = 0; i < stats.tagCount; i++){
+    HG_LOG("Arena %s:   %-12s %.1f KB",
+           name,
+           stats.tags[i].tag,
+           stats.tags[i].bytes / 1024.0);
+  }
+  if(stats.otherBytes > 0){
+    HG_LOG("Arena %s:   %-12s %.1f KB",
+           name,
+           "other",
+           stats.otherBytes / 1024.0);
+  }
+#endif /* HGL_ARENA_STATS */
+}
+
+void hgArenaResetPeak(HgArena *arena){
+#ifdef HGL_ARENA_STATS
+  arena->stats.peak = arena->blockBase + arena->dataPosition;
+#else
+  (void)(arena);
+#endif /* HGL_ARENA_STATS */
 }
 
 #endif /* HGL_ARENA_IMPLEMENTATION */
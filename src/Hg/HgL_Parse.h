@@ -0,0 +1,519 @@
+/*
+ *  HGL_Parse - v0.1 - simple stb style, locale free number
+ *                     parsing for text asset formats
+ *                     (obj, mtl, ...).
+ *
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT (see bottom of file)
+ *  No warranty implied; use at your own risk
+ *
+ *  TO CREATE THE IMPLEMENTATION:
+ *  define HGL_PARSE_IMPLEMENTATION before including
+ *  HgL_Parse.h
+ *
+ *      Example:
+ *
+ *      #include ...
+ *      #define HGL_PARSE_IMPLEMENTATION
+ *      #include "HgL_Parse.h"
+ */
+
+#ifndef HGL_PARSE_H
+#define HGL_PARSE_H
+
+#include <stdint.h>
+
+/*
+ *  DOCUMENTATION:
+ *
+ *  Why not strtof/atof:
+ *
+ *  libc number parsing needs a null terminated string (mapped
+ *  files don't have one), depends on the locale (a ',' decimal
+ *  point breaks every asset), and is slow enough to be most of
+ *  the time spent loading a big mesh.
+ *
+ *  These parse straight out of a buffer, always use '.' and
+ *  round to the nearest float, the same as strtof does in the
+ *  "C" locale.
+ *
+ *  Basic Usage:
+ */
+
+const char* hgParseFloat(const char *str, const char *end, float *out);
+
+const char* hgParseInt(const char *str, const char *end, int64_t *out);
+
+/*
+ *    str : start of the number, spaces are NOT skipped
+ *
+ *    end : end of the buffer, parsing never reads past it
+ *
+ *    out : the number parsed, left alone on failure
+ *
+ *    returns : a pointer to the first char after the number,
+ *              or NULL if there is no number at str (or an
+ *              int is too large for int64_t)
+ *
+ *  Floats take the same forms as strtof: an optional sign,
+ *  digits with an optional '.', an optional exponent
+ *  (e.g: "-1.5e-3"), "inf", "infinity" and "nan". Hex floats
+ *  are not supported. Ints are an optional sign and digits.
+ *
+ *  How floats are rounded:
+ *
+ *  Most numbers in assets have few digits and small
+ *  exponents, those are exact in a double and are done with
+ *  one multiply or divide (Clinger's fast path). The rest use
+ *  Eisel-Lemire, a 128 bit multiply by a table of powers of
+ *  5. In the rare cases neither can tell which way to round,
+ *  the number is handed to strtof.
+ *
+ *  END OF DOCUMENTATION
+ */
+
+#endif /* HGL_PARSE_H */
+
+#ifdef HGL_PARSE_IMPLEMENTATION
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <math.h>
+
+/* Most significant digits kept, any more and a uint64_t can overflow */
+#define HGL_PARSE_MAX_DIGITS 19
+
+/* Longest number handed to strtof, longer ones keep the (1 ulp) guess */
+#define HGL_PARSE_MAX_FALLBACK 128
+
+/* Powers of 10 past these are always 0 or inf as a float */
+#define HGL_PARSE_MIN_POW10 -65
+#define HGL_PARSE_MAX_POW10 38
+
+/* Float layout */
+#define HGL_PARSE_MANTISSA_BITS 23
+#define HGL_PARSE_EXPONENT_BIAS 127
+#define HGL_PARSE_INF_EXPONENT 0xff
+
+/* Exact doubles for Clinger's fast path */
+static const double hgl_parse_pow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* The top 128 bits of 5^q, from HGL_PARSE_MIN_POW10 to
+ * HGL_PARSE_MAX_POW10. Negative powers are rounded up */
+static const uint64_t hgl_parse_pow5[][2] = {
+  {0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull}, /* 5^-65 */
+  {0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull}, /* 5^-64 */
+  {0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull}, /* 5^-63 */
+  {0x83a3eeeef9153e89ull, 0x1953cf68300424acull}, /* 5^-62 */
+  {0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull}, /* 5^-61 */
+  {0xcdb02555653131b6ull, 0x3792f412cb06794dull}, /* 5^-60 */
+  {0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull}, /* 5^-59 */
+  {0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull}, /* 5^-58 */
+  {0xc8de047564d20a8bull, 0xf245825a5a445275ull}, /* 5^-57 */
+  {0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull}, /* 5^-56 */
+  {0x9ced737bb6c4183dull, 0x55464dd69685606bull}, /* 5^-55 */
+  {0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull}, /* 5^-54 */
+  {0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull}, /* 5^-53 */
+  {0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull}, /* 5^-52 */
+  {0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull}, /* 5^-51 */
+  {0xef73d256a5c0f77cull, 0x963e66858f6d4440ull}, /* 5^-50 */
+  {0x95a8637627989aadull, 0xdde7001379a44aa8ull}, /* 5^-49 */
+  {0xbb127c53b17ec159ull, 0x5560c018580d5d52ull}, /* 5^-48 */
+  {0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull}, /* 5^-47 */
+  {0x9226712162ab070dull, 0xcab3961304ca70e8ull}, /* 5^-46 */
+  {0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull}, /* 5^-45 */
+  {0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull}, /* 5^-44 */
+  {0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull}, /* 5^-43 */
+  {0xb267ed1940f1c61cull, 0x55f038b237591ed3ull}, /* 5^-42 */
+  {0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull}, /* 5^-41 */
+  {0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull}, /* 5^-40 */
+  {0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull}, /* 5^-39 */
+  {0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull}, /* 5^-38 */
+  {0x881cea14545c7575ull, 0x7e50d64177da2e54ull}, /* 5^-37 */
+  {0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull}, /* 5^-36 */
+  {0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull}, /* 5^-35 */
+  {0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull}, /* 5^-34 */
+  {0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull}, /* 5^-33 */
+  {0xcfb11ead453994baull, 0x67de18eda5814af2ull}, /* 5^-32 */
+  {0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull}, /* 5^-31 */
+  {0xa2425ff75e14fc31ull, 0xa1258379a94d028dull}, /* 5^-30 */
+  {0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull}, /* 5^-29 */
+  {0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull}, /* 5^-28 */
+  {0x9e74d1b791e07e48ull, 0x775ea264cf55347eull}, /* 5^-27 */
+  {0xc612062576589ddaull, 0x95364afe032a819eull}, /* 5^-26 */
+  {0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull}, /* 5^-25 */
+  {0x9abe14cd44753b52ull, 0xc4926a9672793543ull}, /* 5^-24 */
+  {0xc16d9a0095928a27ull, 0x75b7053c0f178294ull}, /* 5^-23 */
+  {0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull}, /* 5^-22 */
+  {0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull}, /* 5^-21 */
+  {0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull}, /* 5^-20 */
+  {0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull}, /* 5^-19 */
+  {0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull}, /* 5^-18 */
+  {0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull}, /* 5^-17 */
+  {0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull}, /* 5^-16 */
+  {0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull}, /* 5^-15 */
+  {0xb424dc35095cd80full, 0x538484c19ef38c95ull}, /* 5^-14 */
+  {0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull}, /* 5^-13 */
+  {0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull}, /* 5^-12 */
+  {0xafebff0bcb24aafeull, 0xf78f69a51539d749ull}, /* 5^-11 */
+  {0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull}, /* 5^-10 */
+  {0x89705f4136b4a597ull, 0x31680a88f8953031ull}, /* 5^-9 */
+  {0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull}, /* 5^-8 */
+  {0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull}, /* 5^-7 */
+  {0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull}, /* 5^-6 */
+  {0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull}, /* 5^-5 */
+  {0xd1b71758e219652bull, 0xd3c36113404ea4a9ull}, /* 5^-4 */
+  {0x83126e978d4fdf3bull, 0x645a1cac083126eaull}, /* 5^-3 */
+  {0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull}, /* 5^-2 */
+  {0xccccccccccccccccull, 0xcccccccccccccccdull}, /* 5^-1 */
+  {0x8000000000000000ull, 0x0000000000000000ull}, /* 5^0 */
+  {0xa000000000000000ull, 0x0000000000000000ull}, /* 5^1 */
+  {0xc800000000000000ull, 0x0000000000000000ull}, /* 5^2 */
+  {0xfa00000000000000ull, 0x0000000000000000ull}, /* 5^3 */
+  {0x9c40000000000000ull, 0x0000000000000000ull}, /* 5^4 */
+  {0xc350000000000000ull, 0x0000000000000000ull}, /* 5^5 */
+  {0xf424000000000000ull, 0x0000000000000000ull}, /* 5^6 */
+  {0x9896800000000000ull, 0x0000000000000000ull}, /* 5^7 */
+  {0xbebc200000000000ull, 0x0000000000000000ull}, /* 5^8 */
+  {0xee6b280000000000ull, 0x0000000000000000ull}, /* 5^9 */
+  {0x9502f90000000000ull, 0x0000000000000000ull}, /* 5^10 */
+  {0xba43b74000000000ull, 0x0000000000000000ull}, /* 5^11 */
+  {0xe8d4a51000000000ull, 0x0000000000000000ull}, /* 5^12 */
+  {0x9184e72a00000000ull, 0x0000000000000000ull}, /* 5^13 */
+  {0xb5e620f480000000ull, 0x0000000000000000ull}, /* 5^14 */
+  {0xe35fa931a0000000ull, 0x0000000000000000ull}, /* 5^15 */
+  {0x8e1bc9bf04000000ull, 0x0000000000000000ull}, /* 5^16 */
+  {0xb1a2bc2ec5000000ull, 0x0000000000000000ull}, /* 5^17 */
+  {0xde0b6b3a76400000ull, 0x0000000000000000ull}, /* 5^18 */
+  {0x8ac7230489e80000ull, 0x0000000000000000ull}, /* 5^19 */
+  {0xad78ebc5ac620000ull, 0x0000000000000000ull}, /* 5^20 */
+  {0xd8d726b7177a8000ull, 0x0000000000000000ull}, /* 5^21 */
+  {0x878678326eac9000ull, 0x0000000000000000ull}, /* 5^22 */
+  {0xa968163f0a57b400ull, 0x0000000000000000ull}, /* 5^23 */
+  {0xd3c21bcecceda100ull, 0x0000000000000000ull}, /* 5^24 */
+  {0x84595161401484a0ull, 0x0000000000000000ull}, /* 5^25 */
+  {0xa56fa5b99019a5c8ull, 0x0000000000000000ull}, /* 5^26 */
+  {0xcecb8f27f4200f3aull, 0x0000000000000000ull}, /* 5^27 */
+  {0x813f3978f8940984ull, 0x4000000000000000ull}, /* 5^28 */
+  {0xa18f07d736b90be5ull, 0x5000000000000000ull}, /* 5^29 */
+  {0xc9f2c9cd04674edeull, 0xa400000000000000ull}, /* 5^30 */
+  {0xfc6f7c4045812296ull, 0x4d00000000000000ull}, /* 5^31 */
+  {0x9dc5ada82b70b59dull, 0xf020000000000000ull}, /* 5^32 */
+  {0xc5371912364ce305ull, 0x6c28000000000000ull}, /* 5^33 */
+  {0xf684df56c3e01bc6ull, 0xc732000000000000ull}, /* 5^34 */
+  {0x9a130b963a6c115cull, 0x3c7f400000000000ull}, /* 5^35 */
+  {0xc097ce7bc90715b3ull, 0x4b9f100000000000ull}, /* 5^36 */
+  {0xf0bdc21abb48db20ull, 0x1e86d40000000000ull}, /* 5^37 */
+  {0x96769950b50d88f4ull, 0x1314448000000000ull}, /* 5^38 */
+};
+
+typedef struct HglParseU128 {
+  uint64_t low;
+  uint64_t high;
+}HglParseU128;
+
+HglParseU128 hgl_parse_mul(uint64_t a, uint64_t b){
+  HglParseU128 result;
+#ifdef __SIZEOF_INT128__
+  __extension__ unsigned __int128 product = (unsigned __int128)a * b;
+  result.low = (uint64_t)product;
+  result.high = (uint64_t)(product >> 64);
+#else
+  uint64_t aLow = (uint32_t)a, aHigh = a >> 32;
+  uint64_t bLow = (uint32_t)b, bHigh = b >> 32;
+  uint64_t lowLow = aLow * bLow;
+  uint64_t highLow = aHigh * bLow;
+  uint64_t lowHigh = aLow * bHigh;
+  uint64_t mid = (lowLow >> 32) + (uint32_t)highLow + (uint32_t)lowHigh;
+  result.low = (mid << 32) | (uint32_t)lowLow;
+  result.high = aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32) + (mid >> 32);
+#endif
+  return result;
+}
+
+int hgl_parse_leadingZeros(uint64_t value){
+  int count = 0;
+  while(!(value & (1ull << 63))){
+    value <<= 1;
+    count++;
+  }
+  return count;
+}
+
+/* Eisel-Lemire for w * 10^q (w != 0). Fills in the float's bits, and
+ * returns false if they might be 1 ulp off */
+bool hgl_parse_eiselLemire(uint64_t w, int64_t q, uint32_t *bits){
+  if(q < HGL_PARSE_MIN_POW10){
+    *bits = 0;
+    return true;
+  }
+  if(q > HGL_PARSE_MAX_POW10){
+    *bits = (uint32_t)HGL_PARSE_INF_EXPONENT << HGL_PARSE_MANTISSA_BITS;
+    return true;
+  }
+
+  int lz = hgl_parse_leadingZeros(w);
+  w <<= lz;
+
+  /* Only the bits a float needs (plus 3 for rounding) have to be right.
+   * If they might carry, bring in the next 64 bits of the power */
+  const uint64_t *pow5 = hgl_parse_pow5[q - HGL_PARSE_MIN_POW10];
+  const uint64_t precisionMask = ~0ull >> (HGL_PARSE_MANTISSA_BITS + 3);
+  HglParseU128 product = hgl_parse_mul(w, pow5[0]);
+  if((product.high & precisionMask) == precisionMask){
+    HglParseU128 second = hgl_parse_mul(w, pow5[1]);
+    product.low += second.high;
+    if(second.high > product.low){
+      product.high++;
+    }
+  }
+  bool isKnown = !(product.low == ~0ull && (q < -27 || q > 55));
+
+  int upperBit = (int)(product.high >> 63);
+  int shift = upperBit + 64 - HGL_PARSE_MANTISSA_BITS - 3;
+  uint64_t mantissa = product.high >> shift;
+  /* floor(log2(10^q)) + 63 */
+  int64_t power2 = (((152170 + 65536) * q) >> 16) + 63
+                   + upperBit - lz + HGL_PARSE_EXPONENT_BIAS;
+
+  if(power2 <= 0){
+    /* subnormal */
+    if(-power2 + 1 >= 64){
+      *bits = 0;
+      return true;
+    }
+    mantissa >>= -power2 + 1;
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    /* rounding up to the smallest normal is the same bits */
+    *bits = (uint32_t)mantissa;
+    return isKnown;
+  }
+
+  /* Exactly half way, round to even. Only possible for small q */
+  if(product.low <= 1 && q >= -17 && q <= 10 && (mantissa & 3) == 1
+     && (mantissa << shift) == product.high){
+    mantissa &= ~1ull;
+  }
+  mantissa += (mantissa & 1);
+  mantissa >>= 1;
+  if(mantissa >= (2ull << HGL_PARSE_MANTISSA_BITS)){
+    mantissa = 1ull << HGL_PARSE_MANTISSA_BITS;
+    power2++;
+  }
+  mantissa &= ~(1ull << HGL_PARSE_MANTISSA_BITS);
+  if(power2 >= HGL_PARSE_INF_EXPONENT){
+    power2 = HGL_PARSE_INF_EXPONENT;
+    mantissa = 0;
+  }
+  *bits = (uint32_t)((uint64_t)power2 << HGL_PARSE_MANTISSA_BITS | mantissa);
+  return isKnown;
+}
+
+/* Clinger: mantissa and 10^exponent are both exact doubles, so one op
+ * rounds it right as a double. Going on to float is only wrong if that
+ * landed exactly half way between two floats */
+bool hgl_parse_clinger(uint64_t mantissa, int64_t exponent, float *out){
+  if(mantissa > (1ull << 53) || exponent < -22 || exponent > 22){
+    return false;
+  }
+  double value = (double)mantissa;
+  value = (exponent < 0) ? value / hgl_parse_pow10[-exponent]
+                         : value * hgl_parse_pow10[exponent];
+
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint64_t halfWay = 1ull << (52 - HGL_PARSE_MANTISSA_BITS - 1);
+  if((bits & (halfWay * 2 - 1)) == halfWay){
+    return false;
+  }
+  *out = (float)value;
+  return true;
+}
+
+/* The slow but always right way. The string is copied so it can be null
+ * terminated, and '.' swapped for whatever the locale uses */
+bool hgl_parse_fallback(const char *str, const char *end, float *out){
+  char number[HGL_PARSE_MAX_FALLBACK];
+  size_t len = (size_t)(end - str);
+  if(len >= sizeof(number)){
+    return false;
+  }
+  char point = localeconv()->decimal_point[0];
+  for(size_t i = 0; i < len; i++){
+    number[i] = (str[i] == '.') ? point : str[i];
+  }
+  number[len] = '\0';
+  *out = strtof(number, NULL);
+  return true;
+}
+
+/* "inf", "infinity" or "nan", any case */
+const char* hgl_parse_special(const char *str, const char *end, float *out){
+  static const char *words[] = {"infinity", "inf", "nan"};
+  for(int i = 0; i < 3; i++){
+    size_t len = strlen(words[i]);
+    if((size_t)(end - str) < len){
+      continue;
+    }
+    size_t j = 0;
+    while(j < len && (str[j] | 0x20) == words[i][j]){
+      j++;
+    }
+    if(j == len){
+      *out = (i == 2) ? NAN : INFINITY;
+      return str + len;
+    }
+  }
+  return NULL;
+}
+
+const char* hgParseFloat(const char *str, const char *end, float *out){
+  const char *p = str;
+  bool isNegative = false;
+  if(p < end && (*p == '-' || *p == '+')){
+    isNegative = (*p == '-');
+    p++;
+  }
+  const char *number = p;
+
+  /* value = mantissa * 10^exponent, with only the first
+   * HGL_PARSE_MAX_DIGITS significant digits in mantissa */
+  uint64_t mantissa = 0;
+  int64_t exponent = 0;
+  int digits = 0;
+  bool isTruncated = false;
+  bool hasDigits = false;
+
+  while(p < end && *p >= '0' && *p <= '9'){
+    uint64_t digit = *p++ - '0';
+    hasDigits = true;
+    if(digits < HGL_PARSE_MAX_DIGITS){
+      mantissa = mantissa * 10 + digit;
+      digits += (mantissa != 0);
+    }else{
+      exponent++;
+      isTruncated |= (digit != 0);
+    }
+  }
+  if(p < end && *p == '.'){
+    p++;
+    while(p < end && *p >= '0' && *p <= '9'){
+      uint64_t digit = *p++ - '0';
+      hasDigits = true;
+      if(digits < HGL_PARSE_MAX_DIGITS){
+        mantissa = mantissa * 10 + digit;
+        digits += (mantissa != 0);
+        exponent--;
+      }else{
+        isTruncated |= (digit != 0);
+      }
+    }
+  }
+
+  if(!hasDigits){
+    float special;
+    if(p != number || (p = hgl_parse_special(p, end, &special)) == NULL){
+      return NULL;
+    }
+    *out = isNegative ? -special : special;
+    return p;
+  }
+
+  /* the exponent is only part of the number if it has digits */
+  if(p < end && (*p | 0x20) == 'e'){
+    const char *e = p + 1;
+    bool isExpNegative = false;
+    if(e < end && (*e == '-' || *e == '+')){
+      isExpNegative = (*e == '-');
+      e++;
+    }
+    if(e < end && *e >= '0' && *e <= '9'){
+      int64_t value = 0;
+      while(e < end && *e >= '0' && *e <= '9'){
+        if(value < 100000){
+          value = value * 10 + (*e - '0');
+        }
+        e++;
+      }
+      exponent += isExpNegative ? -value : value;
+      p = e;
+    }
+  }
+
+  /* Truncated, the real value is between mantissa and mantissa + 1 */
+  float result = 0.0f;
+  uint32_t bits = 0;
+  uint32_t upperBits = 0;
+  if(mantissa == 0){
+    result = 0.0f;
+  }else if(!isTruncated && hgl_parse_clinger(mantissa, exponent, &result)){
+    /* done */
+  }else if(hgl_parse_eiselLemire(mantissa, exponent, &bits)
+           && (!isTruncated
+               || (hgl_parse_eiselLemire(mantissa + 1, exponent, &upperBits)
+                   && upperBits == bits))){
+    memcpy(&result, &bits, sizeof(result));
+  }else if(!hgl_parse_fallback(number, p, &result)){
+    /* too long for the fallback, so 1 ulp off at worst */
+    memcpy(&result, &bits, sizeof(result));
+  }
+  *out = isNegative ? -result : result;
+  return p;
+}
+
+const char* hgParseInt(const char *str, const char *end, int64_t *out){
+  const char *p = str;
+  bool isNegative = false;
+  if(p < end && (*p == '-' || *p == '+')){
+    isNegative = (*p == '-');
+    p++;
+  }
+  const char *digits = p;
+  uint64_t value = 0;
+  while(p < end && *p >= '0' && *p <= '9'){
+    uint64_t digit = *p - '0';
+    if(value > (INT64_MAX - digit) / 10){
+      return NULL;
+    }
+    value = value * 10 + digit;
+    p++;
+  }
+  if(p == digits){
+    return NULL;
+  }
+  *out = isNegative ? -(int64_t)value : (int64_t)value;
+  return p;
+}
+
+#endif /* HGL_PARSE_IMPLEMENTATION */
+
+/*
+  LICENSE (MIT)
+
+  Copyright (c) 2024 Gwenivere Benzschawel
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
@@ -0,0 +1,335 @@
+/*
+ *  HGL_Pool - v0.1 - simple stb style implimentation
+ *                    of a fixed size block pool, carved
+ *                    out of an HgArena.
+ *
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT (see bottom of file)
+ *  No warranty implied; use at your own risk
+ *
+ *  Requires HgL_Arena.h, include it before this file.
+ *
+ *  TO CREATE THE IMPLEMENTATION:
+ *  define HGL_POOL_IMPLEMENTATION before including
+ *  HgL_Pool.h (after the HgL_Arena.h implementation)
+ *
+ *      Example:
+ *
+ *      #include ...
+ *      #define HGL_ARENA_IMPLEMENTATION
+ *      #include "HgL_Arena.h"
+ *      #define HGL_POOL_IMPLEMENTATION
+ *      #include "HgL_Pool.h"
+ */
+
+#ifndef HGL_POOL_H
+#define HGL_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct HgPool HgPool;
+
+/*
+ *  DOCUMENTATION:
+ *
+ *  What is a Pool Allocator:
+ *
+ *  A Pool Allocator hands out blocks (slots) that are all the
+ *  same size. Freed slots go on a free list and are handed out
+ *  again by the next alloc, so unlike an arena, memory can be
+ *  returned in any order. Both alloc and free are O(1).
+ *
+ *  Pools get their memory from an HgArena, a block of slots at
+ *  a time. When a block is full another one is pushed onto the
+ *  arena, so a pool only lives as long as the arena memory under
+ *  it.
+ *
+ *  Basic Usage:
+ *  First you must create an HgPool:
+ */
+
+HgPool* hgCreatePool(HgArena *hgArena,
+                     uint64_t slotSize,
+                     uint64_t slotsPerBlock);
+
+/*
+ *    hgArena : arena the pool pushes its memory onto
+ *
+ *    slotSize : size in bytes of one slot. Slots are at least
+ *               pointer sized, and aligned to HGL_POOL_ALIGN
+ *
+ *    slotsPerBlock : how many slots are pushed onto the arena
+ *                    each time the pool runs out
+ *
+ *  Then alloc and free slots in whatever order you need:
+ */
+
+void* hgPoolAlloc(HgPool *hgPool);
+
+void* hgPoolAllocZero(HgPool *hgPool);
+
+void hgPoolFree(HgPool *hgPool, void *slot);
+
+/*
+ *  To free every slot at once (the blocks are kept for reuse):
+ */
+
+void hgPoolFreeAll(HgPool *hgPool);
+
+/*
+ *  There is no hgDestroyPool, the pool is freed with the arena
+ *  memory it was pushed onto (i.e: pop to a mark taken before
+ *  hgCreatePool).
+ *
+ *  Occupancy Stats:
+ *
+ *  With HGL_POOL_STATS defined (on by default in
+ *  HG_BUILD_DEBUG builds) the pool counts how it is used.
+ *  Without it, hgPoolGetStats only fills in slotSize, blocks
+ *  and capacity.
+ */
+
+typedef struct HgPoolStats {
+  uint64_t slotSize;
+  uint64_t blocks;     /* blocks pushed onto the arena */
+  uint64_t capacity;   /* slots in all blocks */
+  uint64_t used;       /* slots currently alloced */
+  uint64_t peakUsed;   /* most slots alloced at once */
+  uint64_t allocs;     /* total hgPoolAlloc calls */
+  uint64_t frees;      /* total hgPoolFree calls */
+}HgPoolStats;
+
+HgPoolStats hgPoolGetStats(HgPool *hgPool);
+
+/* Slots are aligned to this, define before including to change it */
+#ifndef HGL_POOL_ALIGN
+#define HGL_POOL_ALIGN 16
+#endif /* HGL_POOL_ALIGN */
+
+#ifdef HG_BUILD_DEBUG
+#ifndef HGL_POOL_STATS
+#define HGL_POOL_STATS
+#endif /* HGL_POOL_STATS */
+#endif /* HG_BUILD_DEBUG */
+
+/*
+ *  END OF DOCUMENTATION
+ */
+
+#endif /* HGL_POOL_H */
+
+#ifdef HGL_POOL_IMPLEMENTATION
+
+#include <string.h>
+
+/* Header at the start of every block pushed onto the arena */
+typedef struct HgPoolBlock {
+  struct HgPoolBlock *next;
+}HgPoolBlock;
+
+/* Intrusive free list, stored inside the free slots themselves */
+typedef struct HgPoolSlot {
+  struct HgPoolSlot *next;
+}HgPoolSlot;
+
+struct HgPool {
+  HgArena *arena;
+  uint64_t slotSize;
+  uint64_t slotsPerBlock;
+
+  HgPoolSlot *freeList;
+
+  /* Blocks, and the next never used slot of the current block */
+  HgPoolBlock *firstBlock;
+  HgPoolBlock *currentBlock;
+  uint64_t nextSlot;
+
+  HgPoolStats stats;
+};
+
+/* Size of the block header, so the first slot stays aligned */
+#define HGL_POOL_BLOCK_HEADER \
+  ((sizeof(HgPoolBlock) + HGL_POOL_ALIGN - 1) & ~(uint64_t)(HGL_POOL_ALIGN - 1))
+
+HgPool* hgCreatePool(HgArena *arena,
+                     uint64_t slotSize,
+                     uint64_t slotsPerBlock){
+  if(slotSize == 0 || slotsPerBlock == 0){
+    HG_ERROR("Can't make an HgPool with no slots!");
+    return NULL;
+  }
+
+  HgPool *pool = (HgPool*)hgArenaPush(arena, sizeof(HgPool));
+  if(pool == NULL){
+    HG_ERROR("Out of Memory, Can't make new HgPool!");
+    return NULL;
+  }
+
+  if(slotSize < sizeof(HgPoolSlot)){
+    slotSize = sizeof(HgPoolSlot);
+  }
+  slotSize = (slotSize + HGL_POOL_ALIGN - 1)
+             & ~(uint64_t)(HGL_POOL_ALIGN - 1);
+
+  pool->arena = arena;
+  pool->slotSize = slotSize;
+  pool->slotsPerBlock = slotsPerBlock;
+  pool->freeList = NULL;
+  pool->firstBlock = NULL;
+  pool->currentBlock = NULL;
+  pool->nextSlot = 0;
+  memset(&pool->stats, 0, sizeof(HgPoolStats));
+  pool->stats.slotSize = slotSize;
+  return pool;
+}
+
+/* Move on to the next block, pushing a new one if needed */
+int hgl_pool_nextBlock(HgPool *pool){
+  if(pool->currentBlock != NULL && pool->currentBlock->next != NULL){
+    pool->currentBlock = pool->currentBlock->next;
+    pool->nextSlot = 0;
+    return 0;
+  }
+
+  HgPoolBlock *block = (HgPoolBlock*)hgArenaPushAligned(
+      pool->arena,
+      HGL_POOL_BLOCK_HEADER + pool->slotSize * pool->slotsPerBlock,
+      HGL_POOL_ALIGN);
+  if(block == NULL){
+    return -1;
+  }
+  block->next = NULL;
+
+  if(pool->currentBlock == NULL){
+    pool->firstBlock = block;
+  }else{
+    pool->currentBlock->next = block;
+  }
+  pool->currentBlock = block;
+  pool->nextSlot = 0;
+
+  pool->stats.blocks++;
+  pool->stats.capacity += pool->slotsPerBlock;
+  return 0;
+}
+
+void* hgPoolAlloc(HgPool *pool){
+  void *slot = NULL;
+
+  if(pool->freeList != NULL){
+    slot = pool->freeList;
+    pool->freeList = pool->freeList->next;
+  }else{
+    if(pool->currentBlock == NULL || pool->nextSlot == pool->slotsPerBlock){
+      if(hgl_pool_nextBlock(pool)){
+        HG_ERROR("Pool Alloc FAILED! Out of memory!");
+        return NULL;
+      }
+    }
+    slot = (uint8_t*)pool->currentBlock
+           + HGL_POOL_BLOCK_HEADER
+           + pool->nextSlot * pool->slotSize;
+    pool->nextSlot++;
+  }
+
+#ifdef HGL_POOL_STATS
+  pool->stats.allocs++;
+  pool->stats.used++;
+  if(pool->stats.used > pool->stats.peakUsed){
+    pool->stats.peakUsed = pool->stats.used;
+  }
+#endif /* HGL_POOL_STATS */
+  return slot;
+}
+
+void* hgPoolAllocZero(HgPool *pool){
+  void *slot = hgPoolAlloc(pool);
+  if(slot != NULL){
+    memset(slot, 0, pool->slotSize);
+  }
+  return slot;
+}
+
+void hgPoolFree(HgPool *pool, void *slot){
+  if(slot == NULL){
+    return;
+  }
+
+#ifdef HG_BUILD_DEBUG
+  /* Make sure the slot really came from this pool, and was handed out
+   * (slots past nextSlot of the current block never were) */
+  bool isFound = false;
+  bool isPastCurrent = false;
+  for(HgPoolBlock *block = pool->firstBlock; block; block = block->next){
+    uint8_t *first = (uint8_t*)block + HGL_POOL_BLOCK_HEADER;
+    uint8_t *end = (block == pool->currentBlock)
+                   ? first + pool->slotSize * pool->nextSlot
+                   : first + pool->slotSize * pool->slotsPerBlock;
+    if(!isPastCurrent && (uint8_t*)slot >= first && (uint8_t*)slot < end){
+      isFound = ((uint8_t*)slot - first) % pool->slotSize == 0;
+      break;
+    }
+    isPastCurrent = isPastCurrent || block == pool->currentBlock;
+  }
+  if(!isFound){
+    HG_ERROR("Pool Free FAILED! Pointer is not a slot of this pool!");
+    return;
+  }
+  /* A slot freed twice would be handed out twice */
+  for(HgPoolSlot *freeSlot = pool->freeList; freeSlot;
+      freeSlot = freeSlot->next){
+    if(freeSlot == slot){
+      HG_ERROR("Pool Free FAILED! Slot was already freed!");
+      return;
+    }
+  }
+#endif /* HG_BUILD_DEBUG */
+
+  HgPoolSlot *freeSlot = (HgPoolSlot*)slot;
+  freeSlot->next = pool->freeList;
+  pool->freeList = freeSlot;
+
+#ifdef HGL_POOL_STATS
+  pool->stats.frees++;
+  pool->stats.used--;
+#endif /* HGL_POOL_STATS */
+}
+
+void hgPoolFreeAll(HgPool *pool){
+  pool->freeList = NULL;
+  pool->currentBlock = pool->firstBlock;
+  pool->nextSlot = 0;
+  pool->stats.used = 0;
+}
+
+HgPoolStats hgPoolGetStats(HgPool *pool){
+  return pool->stats;
+}
+
+#endif /* HGL_POOL_IMPLEMENTATION */
+
+/*
+  LICENSE (MIT)
+
+  Copyright (c) 2024 Gwenivere Benzschawel
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
@@ -8,5 +8,6 @@
 
 void hgInitEntity(HgEntity *entity, HgMesh *mesh){
   entity->mesh = mesh;
+  entity->lod = 0;
   glm_mat4_identity(entity->trans);
 }
@@ -32,8 +32,10 @@ typedef struct HgGameState HgGameState;
 // Runs once at the start of the game, to set up memory for the game loop.
 void hgStartGame(HgArena *hgArena, HgGameState *gs);
 
-// Runs once per frame. 
+// Runs once per frame. frameArena is emptied before every call, use it
+// for scratch memory that only needs to last the frame.
 void hgGameLoop(HgArena *hgArena,
+                HgArena *frameArena,
                 HgGameState *gs,
                 HgInput *input, 
                 double delta);
@@ -12,6 +12,36 @@
 
 //POSIX
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+//Linux
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/inotify.h>
+#endif /* __linux__ */
+
+#include "hgpak.h"
+#include "hgbake.h"
+
+/* Buffer size for copies the kernel can't do for us */
+#define HG_COPY_BUFFER_SIZE (128 * 1024)
+
+/* Most file changes kept in one frame, extras are dropped */
+#define HG_MAX_FILE_CHANGES 256
+
+/* Background threads reading files for hgLoadFileAsync */
+#define HG_LOAD_THREADS 4
+
+/* The mounted .hgpak, mapped once */
+HgFileMap hgPak = {0};
+
+/* inotify instance for all watches, and this frame's changes */
+int hgWatchFd = -1;
+HgFileChange hgFileChanges[HG_MAX_FILE_CHANGES];
+uint32_t hgFileChangeCount = 0;
 
 size_t hgGetFileSize(const char* fileLoc){
   FILE *fp;
@@ -40,6 +70,231 @@ void hgGetFileStr(char* buffer, size_t size, const char* fileLoc){
   fclose(fp);
 }
 
+int hgMountPak(const char* fileLoc){
+  /* No pak is fine, everything is loaded from loose files */
+  if(access(fileLoc, F_OK) != 0){
+    return -1;
+  }
+  HgFileMap pak = hgMapFile(fileLoc);
+  if(pak.data == NULL){
+    return -1;
+  }
+
+  /* Check everything lookups trust, once */
+  const HgPakHeader *header = (const HgPakHeader*)pak.data;
+  if(pak.size < sizeof(HgPakHeader)
+     || header->magic != HG_PAK_MAGIC
+     || header->version != HG_PAK_VERSION
+     || header->bucketCount == 0
+     || (header->bucketCount & (header->bucketCount - 1)) != 0
+     || header->bucketCount < 2 * (uint64_t)header->entryCount
+     || pak.size < sizeof(HgPakHeader)
+                   + header->bucketCount * sizeof(HgPakEntry)){
+    HG_ERROR("%s is not a valid .hgpak (version %d)", fileLoc, HG_PAK_VERSION);
+    hgUnmapFile(&pak);
+    return -1;
+  }
+  const HgPakEntry *entries = (const HgPakEntry*)(header + 1);
+  uint32_t usedCount = 0;
+  for(uint32_t i = 0; i < header->bucketCount; i++){
+    usedCount += (entries[i].hash != 0);
+    /* names go straight to strcmp, so they have to end inside the pak */
+    if(entries[i].hash != 0
+       && (entries[i].offset > pak.size
+           || entries[i].size > pak.size - entries[i].offset
+           || entries[i].nameOffset >= pak.size
+           || memchr(pak.data + entries[i].nameOffset, '\0',
+                     pak.size - entries[i].nameOffset) == NULL)){
+      HG_ERROR("%s is corrupt, entry %u is out of bounds", fileLoc, i);
+      hgUnmapFile(&pak);
+      return -1;
+    }
+  }
+  /* lookups stop at an empty bucket, so the table can't be full */
+  if(usedCount != header->entryCount){
+    HG_ERROR("%s is corrupt, %u entries in %u buckets, expected %u",
+             fileLoc, usedCount, header->bucketCount, header->entryCount);
+    hgUnmapFile(&pak);
+    return -1;
+  }
+
+  hgUnmapFile(&hgPak);
+  hgPak = pak;
+  HG_LOG("Mounted %s, %u files", fileLoc, header->entryCount);
+  return 0;
+}
+
+const HgPakEntry* hgPakFindEntry(const char* fileLoc){
+  if(hgPak.data == NULL){
+    return NULL;
+  }
+
+  const HgPakHeader *header = (const HgPakHeader*)hgPak.data;
+  const HgPakEntry *entries = (const HgPakEntry*)(header + 1);
+  uint64_t hash = hgPakHash(fileLoc);
+  uint32_t mask = header->bucketCount - 1;
+
+  /* Linear probing, the table is never more than half full (checked by
+   * hgMountPak), and a probe never goes round more than once */
+  uint32_t i = hash & mask;
+  for(uint32_t step = 0;
+      step < header->bucketCount && entries[i].hash != 0;
+      step++, i = (i + 1) & mask){
+    const HgPakEntry *entry = &entries[i];
+    if(entry->hash == hash
+       && strcmp(hgPak.data + entry->nameOffset, fileLoc) == 0){
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/* Number of chunks in a compressed entry, 0 if the entry is corrupt */
+uint32_t hgPakChunkCount(const HgPakEntry* entry){
+  HgPakChunks chunks;
+  if(entry->size < sizeof(HgPakChunks)){
+    return 0;
+  }
+  memcpy(&chunks, hgPak.data + entry->offset, sizeof(HgPakChunks));
+  if(chunks.chunkSize == 0
+     || chunks.chunkCount != (entry->rawSize + chunks.chunkSize - 1)
+                             / chunks.chunkSize
+     || entry->size < sizeof(HgPakChunks)
+                      + (chunks.chunkCount + 1) * sizeof(uint64_t)){
+    return 0;
+  }
+  return chunks.chunkCount;
+}
+
+/* Decode one chunk of a compressed entry into its place in dest. Chunks
+ * don't depend on each other, so threads can each decode a different one */
+int hgPakDecodeChunk(const HgPakEntry* entry, uint32_t chunk, char* dest){
+  const uint8_t *data = (const uint8_t*)hgPak.data + entry->offset;
+  HgPakChunks chunks;
+  memcpy(&chunks, data, sizeof(HgPakChunks));
+
+  uint64_t offsets[2];
+  memcpy(offsets,
+         data + sizeof(HgPakChunks) + chunk * sizeof(uint64_t),
+         sizeof(offsets));
+  if(offsets[0] > offsets[1] || offsets[1] > entry->size){
+    return -1;
+  }
+
+  uint64_t start = (uint64_t)chunk * chunks.chunkSize;
+  uint64_t rawSize = MIN(entry->rawSize - start, (uint64_t)chunks.chunkSize);
+  return hgPakDecodeBlock(data + offsets[0],
+                          offsets[1] - offsets[0],
+                          (uint8_t*)dest + start,
+                          rawSize);
+}
+
+bool hgPakFind(HgArena* arena, const char* fileLoc, HgFileMap* fileMap){
+  const HgPakEntry *entry = hgPakFindEntry(fileLoc);
+  if(entry == NULL){
+    return false;
+  }
+
+  if(!(entry->flags & HG_PAK_COMPRESSED)){
+    fileMap->data = hgPak.data + entry->offset;
+    fileMap->size = entry->size;
+    fileMap->isInPak = true;
+    return true;
+  }
+
+  /* Decoded in one pass, straight to where it'll be used */
+  uint32_t chunkCount = hgPakChunkCount(entry);
+  char *dest = (arena != NULL) ? hgArenaPush(arena, entry->rawSize)
+                               : malloc(entry->rawSize);
+  if(chunkCount == 0 || dest == NULL){
+    HG_ERROR("Failed to decompress %s", fileLoc);
+    if(arena == NULL){
+      free(dest);
+    }
+    return false;
+  }
+  for(uint32_t i = 0; i < chunkCount; i++){
+    if(hgPakDecodeChunk(entry, i, dest)){
+      HG_ERROR("Failed to decompress %s, it's corrupt", fileLoc);
+      if(arena == NULL){
+        free(dest);
+      }
+      return false;
+    }
+  }
+  fileMap->data = dest;
+  fileMap->size = entry->rawSize;
+  fileMap->isInPak = true;
+  fileMap->isDecoded = (arena == NULL);
+  return true;
+}
+
+HgFileMap hgMapFile(const char* fileLoc){
+  return hgMapFileEx(NULL, fileLoc);
+}
+
+HgFileMap hgMapFileEx(HgArena* arena, const char* fileLoc){
+  HgFileMap fileMap = {0};
+
+#ifdef HG_BUILD_DEBUG
+  /* While developing, loose files override the pak */
+  int fd = open(fileLoc, O_RDONLY);
+  if(fd == -1 && hgPakFind(arena, fileLoc, &fileMap)){
+    return fileMap;
+  }
+#else
+  if(hgPakFind(arena, fileLoc, &fileMap)){
+    return fileMap;
+  }
+  int fd = open(fileLoc, O_RDONLY);
+#endif /* HG_BUILD_DEBUG */
+  if(fd == -1){
+    HG_ERROR("Failed to load file: %s", fileLoc);
+    return fileMap;
+  }
+
+  struct stat fileStat;
+  if(fstat(fd, &fileStat) != 0){
+    HG_ERROR("Failed to stat file: %s", fileLoc);
+    close(fd);
+    return fileMap;
+  }
+
+  /* mmap can't map 0 bytes, an empty file is just an empty view */
+  if(fileStat.st_size == 0){
+    close(fd);
+    fileMap.data = "";
+    return fileMap;
+  }
+
+  void *data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data == MAP_FAILED){
+    HG_ERROR("Failed to map file: %s", fileLoc);
+    return fileMap;
+  }
+
+  /* Loaders read files front to back, once */
+  madvise(data, fileStat.st_size, MADV_WILLNEED);
+  madvise(data, fileStat.st_size, MADV_SEQUENTIAL);
+
+  fileMap.data = (const char*)data;
+  fileMap.size = fileStat.st_size;
+  return fileMap;
+}
+
+void hgUnmapFile(HgFileMap *fileMap){
+  if(fileMap->isDecoded){
+    free((void*)fileMap->data);
+  }else if(fileMap->data != NULL && fileMap->size > 0 && !fileMap->isInPak){
+    munmap((void*)fileMap->data, fileMap->size);
+  }
+  fileMap->data = NULL;
+  fileMap->size = 0;
+  fileMap->isInPak = false;
+  fileMap->isDecoded = false;
+}
+
 void hgDeleteFile(const char* file){
   FILE *fp = NULL;
   fp = fopen(file, "r");
@@ -50,34 +305,464 @@ void hgDeleteFile(const char* file){
   remove(file);
 }
 
-void hgCopyFile(const char* src, const char* dest){
-  FILE *srcFp = NULL, *destFp = NULL; 
+/* Copy everything from srcFd's offset to destFd. There is no fsync, the
+ * copy only has to be visible to this machine (i.e. dlopen). */
+int hgCopyFileFd(int srcFd, int destFd, size_t size){
+#ifdef __linux__
+  size_t left = size;
+
+  /* In kernel copies, the data never comes up to user space. Both move
+   * the file offsets, so each one carries on from the last */
+  while(left > 0){
+    ssize_t copied = copy_file_range(srcFd, NULL, destFd, NULL, left, 0);
+    if(copied <= 0){
+      break; /* not supported here (i.e. across file systems) */
+    }
+    left -= copied;
+  }
+  while(left > 0){
+    ssize_t copied = sendfile(destFd, srcFd, NULL, left);
+    if(copied <= 0){
+      break;
+    }
+    left -= copied;
+  }
+  if(left == 0){
+    return 0;
+  }
+#else
+  (void)size;
+#endif /* __linux__ */
 
-  srcFp = fopen(src, "r"); 
-  if(srcFp == NULL){
+  char buffer[HG_COPY_BUFFER_SIZE];
+  ssize_t readSize = 0;
+  while((readSize = read(srcFd, buffer, HG_COPY_BUFFER_SIZE)) > 0){
+    ssize_t written = 0;
+    while(written < readSize){
+      ssize_t writeSize = write(destFd, buffer + written, readSize - written);
+      if(writeSize < 0){
+        return -1;
+      }
+      written += writeSize;
+    }
+  }
+  return (readSize < 0) ? -1 : 0;
+}
+
+void hgCopyFile(const char* src, const char* dest){
+  int srcFd = open(src, O_RDONLY);
+  if(srcFd == -1){
     HG_ERROR("Failed to open %s", src);
     return;
   }
+
+  struct stat srcStat;
+  if(fstat(srcFd, &srcStat) != 0){
+    HG_ERROR("Failed to stat %s", src);
+    close(srcFd);
+    return;
+  }
   
-  destFp = fopen(dest, "w");
-  if(destFp == NULL){
+  int destFd = open(dest, O_WRONLY | O_CREAT | O_TRUNC, srcStat.st_mode & 0777);
+  if(destFd == -1){
     HG_ERROR("Failed to open %s", dest);
-    fclose(srcFp);
+    close(srcFd);
     return;
   }
 
-  int ch = 0;
-  while( (ch = fgetc(srcFp)) != EOF ){
-    fputc(ch, destFp);
+  if(hgCopyFileFd(srcFd, destFd, srcStat.st_size)){
+    HG_ERROR("Failed to copy %s to %s", src, dest);
   }
 
-  fclose(srcFp);
-  fclose(destFp);
+  close(srcFd);
+  close(destFd);
+}
+
+int hgWatchFile(const char* filepath){
+#ifdef __linux__
+  if(hgWatchFd == -1){
+    hgWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(hgWatchFd == -1){
+      HG_ERROR("Failed to start watching files");
+      return -1;
+    }
+  }
 
+  int watchId = inotify_add_watch(hgWatchFd,
+                                  filepath,
+                                  IN_CLOSE_WRITE | IN_MOVED_TO);
+  if(watchId == -1){
+    HG_ERROR("Failed to watch %s", filepath);
+  }
+  return watchId;
+#else
+  HG_WARN("Can't watch %s, file watching not supported", filepath);
+  return -1;
+#endif /* __linux__ */
+}
+
+void hgUnwatchFile(int watchId){
+#ifdef __linux__
+  if(hgWatchFd != -1 && watchId > 0){
+    inotify_rm_watch(hgWatchFd, watchId);
+  }
+#else
+  (void)watchId;
+#endif /* __linux__ */
+}
+
+/* Add a change, unless the file already changed this frame */
+void hgAddFileChange(int watchId, const char* name){
+  for(uint32_t i = 0; i < hgFileChangeCount; i++){
+    if(hgFileChanges[i].watchId == watchId
+       && strcmp(hgFileChanges[i].name, name) == 0){
+      return;
+    }
+  }
+  if(hgFileChangeCount == HG_MAX_FILE_CHANGES){
+    HG_WARN("Too many file changes this frame, dropped %s", name);
+    return;
+  }
+  HgFileChange *change = &hgFileChanges[hgFileChangeCount++];
+  change->watchId = watchId;
+  snprintf(change->name, PATH_LENGTH, "%s", name);
+}
+
+/* Called once a frame. Reads every waiting event, never blocks */
+void hgUpdateFileWatch(void){
+  hgFileChangeCount = 0;
+#ifdef __linux__
+  if(hgWatchFd == -1){
+    return;
+  }
+
+  char buffer[16 * 1024];
+  ssize_t readSize = 0;
+  while((readSize = read(hgWatchFd, buffer, sizeof(buffer))) > 0){
+    ssize_t offset = 0;
+    while(offset + (ssize_t)sizeof(struct inotify_event) <= readSize){
+      /* events are packed, copy out so it's aligned */
+      struct inotify_event event;
+      memcpy(&event, buffer + offset, sizeof(struct inotify_event));
+      const char *name = buffer + offset + sizeof(struct inotify_event);
+
+      if(event.mask & IN_Q_OVERFLOW){
+        HG_WARN("File watch queue overflowed, some changes were lost");
+      }else{
+        hgAddFileChange(event.wd, (event.len > 0) ? name : "");
+      }
+      offset += sizeof(struct inotify_event) + event.len;
+    }
+  }
+#endif /* __linux__ */
+}
+
+const HgFileChange* hgGetFileChanges(uint32_t* count){
+  *count = hgFileChangeCount;
+  return hgFileChanges;
+}
+
+struct HgFileLoad {
+  char filepath[PATH_LENGTH];
+  char *data;
+  size_t size;
+  bool isDone;
+  bool isFailed;
+  const HgPakEntry *pakEntry; /* compressed entry to decode, or NULL */
+  uint32_t jobsLeft;          /* with hgLoadMutex locked */
+  HgFileLoadCallback callback;
+  void *userData;
+  struct HgFileLoad *next;
+};
+
+/* A load is split into jobs for the threads. One to read a loose file, or
+ * one for each chunk of a compressed pak entry */
+typedef struct HgLoadJob {
+  HgFileLoad *load;
+  uint32_t chunk;
+  struct HgLoadJob *next;
+}HgLoadJob;
+
+/* Queued loads for the threads, and finished loads for the main thread.
+ * Both lists are only touched with hgLoadMutex locked */
+pthread_t hgLoadThreads[HG_LOAD_THREADS];
+bool hgIsLoadRunning = false;
+bool hgIsLoadStopping = false;
+pthread_mutex_t hgLoadMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t hgLoadQueueCond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t hgLoadDoneCond = PTHREAD_COND_INITIALIZER;
+HgLoadJob *hgLoadQueue = NULL;
+HgLoadJob *hgLoadQueueTail = NULL;
+HgFileLoad *hgLoadDone = NULL;
+HgFileLoad *hgLoadDoneTail = NULL;
+uint32_t hgLoadsInFlight = 0; /* jobs queued or being worked on */
+
+/* Put a load on the done list, with hgLoadMutex locked */
+void hgFinishFileLoad(HgFileLoad* load){
+  load->next = NULL;
+  if(hgLoadDoneTail == NULL){
+    hgLoadDone = load;
+  }else{
+    hgLoadDoneTail->next = load;
+  }
+  hgLoadDoneTail = load;
+}
+
+/* Read a whole loose file into the load's memory */
+bool hgReadFileLoad(HgFileLoad* load){
+  size_t readTotal = 0;
+  int fd = open(load->filepath, O_RDONLY);
+  if(fd == -1){
+    return false;
+  }
+  ssize_t readSize = 0;
+  while(readTotal < load->size
+        && (readSize = read(fd, load->data + readTotal,
+                            load->size - readTotal)) > 0){
+    readTotal += readSize;
+  }
+  close(fd);
+  return readTotal == load->size;
+}
+
+/* Worker thread, reads and decodes queued jobs until told to stop */
+void* hgFileLoadThread(void* arg){
+  (void)arg;
+  pthread_mutex_lock(&hgLoadMutex);
+  while(true){
+    while(hgLoadQueue == NULL && !hgIsLoadStopping){
+      pthread_cond_wait(&hgLoadQueueCond, &hgLoadMutex);
+    }
+    if(hgIsLoadStopping){
+      break;
+    }
+    HgLoadJob *job = hgLoadQueue;
+    hgLoadQueue = job->next;
+    if(hgLoadQueue == NULL){
+      hgLoadQueueTail = NULL;
+    }
+    pthread_mutex_unlock(&hgLoadMutex);
+
+    /* The work is done outside of the lock */
+    HgFileLoad *load = job->load;
+    bool isOk = (load->pakEntry != NULL)
+                ? hgPakDecodeChunk(load->pakEntry, job->chunk, load->data) == 0
+                : hgReadFileLoad(load);
+
+    pthread_mutex_lock(&hgLoadMutex);
+    if(!isOk){
+      load->isFailed = true;
+    }
+    load->jobsLeft--;
+    if(load->jobsLeft == 0){
+      hgFinishFileLoad(load);
+    }
+    hgLoadsInFlight--;
+    pthread_cond_broadcast(&hgLoadDoneCond);
+  }
+  pthread_mutex_unlock(&hgLoadMutex);
+  return NULL;
+}
+
+/* Stop and join the first threadCount threads. Loads still queued are
+ * dropped */
+void hgJoinFileLoadThreads(int threadCount){
+  pthread_mutex_lock(&hgLoadMutex);
+  hgIsLoadStopping = true;
+  pthread_cond_broadcast(&hgLoadQueueCond);
+  pthread_mutex_unlock(&hgLoadMutex);
+  for(int i = 0; i < threadCount; i++){
+    pthread_join(hgLoadThreads[i], NULL);
+  }
+  hgLoadQueue = NULL;
+  hgLoadQueueTail = NULL;
+  hgLoadDone = NULL;
+  hgLoadDoneTail = NULL;
+  hgLoadsInFlight = 0;
+  hgIsLoadStopping = false;
+  hgIsLoadRunning = false;
+}
+
+HgFileLoad* hgLoadFileAsync(HgArena* arena,
+                            const char* filepath,
+                            HgFileLoadCallback callback,
+                            void* userData){
+  if(!hgIsLoadRunning){
+    for(int i = 0; i < HG_LOAD_THREADS; i++){
+      if(pthread_create(&hgLoadThreads[i], NULL, hgFileLoadThread, NULL)){
+        HG_ERROR("Failed to start file loading threads!");
+        /* not left running half started, the next load tries again */
+        hgJoinFileLoadThreads(i);
+        return NULL;
+      }
+    }
+    hgIsLoadRunning = true;
+  }
+
+  /* Sized now so the thread never touches the arena */
+  struct stat fileStat;
+#ifdef HG_BUILD_DEBUG
+  const HgPakEntry *entry = (stat(filepath, &fileStat) != 0)
+                            ? hgPakFindEntry(filepath) : NULL;
+#else
+  const HgPakEntry *entry = hgPakFindEntry(filepath);
+#endif /* HG_BUILD_DEBUG */
+  if(entry == NULL && stat(filepath, &fileStat) != 0){
+    HG_ERROR("Failed to load file: %s", filepath);
+    return NULL;
+  }
+  size_t size = (entry != NULL) ? entry->rawSize : (size_t)fileStat.st_size;
+
+  /* Compressed entries are a job for each chunk, decoded in parallel */
+  bool isCompressed = entry != NULL && (entry->flags & HG_PAK_COMPRESSED);
+  uint32_t jobCount = 1;
+  if(isCompressed){
+    jobCount = hgPakChunkCount(entry);
+    if(jobCount == 0){
+      HG_ERROR("Failed to decompress %s, it's corrupt", filepath);
+      return NULL;
+    }
+  }
+
+  HgFileLoad *load = hgArenaPush(arena, sizeof(HgFileLoad));
+  HgLoadJob *jobs = hgArenaPush(arena, jobCount * sizeof(HgLoadJob));
+  char *data = hgArenaPush(arena, size + 1);
+  if(load == NULL || jobs == NULL || data == NULL){
+    HG_ERROR("Out of Memory, Can't load file: %s", filepath);
+    return NULL;
+  }
+  snprintf(load->filepath, PATH_LENGTH, "%s", filepath);
+  load->data = data;
+  load->data[size] = '\0';
+  load->size = size;
+  load->isDone = false;
+  load->isFailed = false;
+  load->pakEntry = isCompressed ? entry : NULL;
+  load->jobsLeft = jobCount;
+  load->callback = callback;
+  load->userData = userData;
+  load->next = NULL;
+
+  pthread_mutex_lock(&hgLoadMutex);
+  if(entry != NULL && !isCompressed){
+    /* Already in memory, done right away */
+    memcpy(load->data, hgPak.data + entry->offset, size);
+    load->jobsLeft = 0;
+    hgFinishFileLoad(load);
+  }else{
+    for(uint32_t i = 0; i < jobCount; i++){
+      jobs[i].load = load;
+      jobs[i].chunk = i;
+      jobs[i].next = NULL;
+      if(hgLoadQueueTail == NULL){
+        hgLoadQueue = &jobs[i];
+      }else{
+        hgLoadQueueTail->next = &jobs[i];
+      }
+      hgLoadQueueTail = &jobs[i];
+    }
+    hgLoadsInFlight += jobCount;
+    pthread_cond_broadcast(&hgLoadQueueCond);
+  }
+  pthread_mutex_unlock(&hgLoadMutex);
+  return load;
+}
+
+/* Called once a frame, runs the callbacks of finished loads */
+void hgUpdateFileLoads(void){
+  if(!hgIsLoadRunning){
+    return;
+  }
+
+  pthread_mutex_lock(&hgLoadMutex);
+  HgFileLoad *load = hgLoadDone;
+  hgLoadDone = NULL;
+  hgLoadDoneTail = NULL;
+  pthread_mutex_unlock(&hgLoadMutex);
+
+  while(load){
+    /* the callback may start new loads, which reuse next */
+    HgFileLoad *next = load->next;
+    load->isDone = true;
+    if(load->isFailed){
+      HG_ERROR("Failed to load file: %s", load->filepath);
+      load->data = NULL;
+      load->size = 0;
+    }
+    if(load->callback){
+      load->callback(load->userData, load->data, load->size);
+    }
+    load = next;
+  }
+}
+
+bool hgIsFileLoadDone(HgFileLoad* load, char** data, size_t* size){
+  if(load == NULL || !load->isDone){
+    return false;
+  }
+  *data = load->data;
+  *size = load->size;
+  return true;
+}
+
+void hgWaitFileLoads(void){
+  if(!hgIsLoadRunning){
+    return;
+  }
+  pthread_mutex_lock(&hgLoadMutex);
+  while(hgLoadsInFlight > 0){
+    pthread_cond_wait(&hgLoadDoneCond, &hgLoadMutex);
+  }
+  pthread_mutex_unlock(&hgLoadMutex);
+  hgUpdateFileLoads();
+}
+
+/* Stop and join the threads. Loads still queued are dropped */
+void hgStopFileLoads(void){
+  if(!hgIsLoadRunning){
+    return;
+  }
+  hgJoinFileLoadThreads(HG_LOAD_THREADS);
 }
 
 time_t hgFileModTime(const char* file){
   struct stat fileStat;
-  stat(file, &fileStat);
-  return fileStat.st_ctime;
+  if(stat(file, &fileStat) != 0){
+    return 0;
+  }
+  return fileStat.st_mtime;
+}
+
+bool hgFileExists(const char* file){
+  return hgPakFindEntry(file) != NULL || access(file, F_OK) == 0;
+}
+
+/* The stamp a bake keeps of a file it was made from */
+void hgStampBakeSource(HgBakeSource* source,
+                       const char* file,
+                       const HgFileMap* fileMap){
+  snprintf(source->path, HG_BAKE_PATH_LENGTH, "%s", file);
+  source->size = fileMap->size;
+  source->modTime = hgFileModTime(file);
+  source->hash = hgBakeHash(fileMap->data, fileMap->size);
+}
+
+/* Is the file the same as when it was baked? Files that aren't loose (only
+ * in the .hgpak) can't have changed */
+bool hgIsBakeSourceFresh(const HgBakeSource* source){
+  if(source->path[0] == '\0'){
+    return true;
+  }
+  time_t modTime = hgFileModTime(source->path);
+  if(modTime == 0 || modTime == source->modTime){
+    return true;
+  }
+  /* touched (or copied without keeping times), only stale if the
+   * contents changed */
+  HgFileMap fileMap = hgMapFile(source->path);
+  bool isFresh = fileMap.data != NULL
+                 && fileMap.size == source->size
+                 && hgBakeHash(fileMap.data, fileMap.size) == source->hash;
+  hgUnmapFile(&fileMap);
+  return isFresh;
 }
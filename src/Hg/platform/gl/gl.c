@@ -18,6 +18,10 @@ struct HgVertexBuffer{
   uint32_t vbo;
   uint32_t ibo;
   uint32_t count;
+  uint32_t indexType; /* GL_UNSIGNED_SHORT or GL_UNSIGNED_INT */
+  uint32_t layout;    /* HG_VERTEX_FLOAT or HG_VERTEX_COMPACT */
+  vec3 posOffset;     /* compact positions are 0-1, these take them back */
+  vec3 posScale;      /* to the mesh's own space */
 };
 
 struct HgTexture{
@@ -30,6 +34,10 @@ struct HgTexture{
 struct HgMesh{
   HgVertexBuffer vb;
   HgTexture t;
+  HgMeshLod lods[HG_MESH_MAX_LODS];
+  uint32_t lodCount;
+  vec3 centre;  /* bounding sphere, to pick a LOD by */
+  float radius;
 };
 
 HgShader meshShader = {0};
@@ -6,21 +6,76 @@
  *  Purpose: Handles actually rendering meshes or other objects to screen.
  */
 
+/* A LOD is drawn once its error would cover less than this much of the
+ * screen's height, about a pixel at 1080p */
+#define HG_LOD_SCREEN_ERROR 0.001f
+
+/* How much further under HG_LOD_SCREEN_ERROR a simpler LOD has to be
+ * before switching to it, so entities near the edge don't flicker */
+#define HG_LOD_HYSTERESIS 0.25f
+
 void hgBeginDraw(void){
   GL_CALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));  
 }
 
+/* The entity's LOD this frame, from how much of the screen's height its
+ * bounding sphere covers. Starts from the LOD it drew last */
+uint32_t hgSelectLod(HgEntity *entity, HgCamera *camera){
+  HgMesh *mesh = entity->mesh;
+  if(mesh->lodCount <= 1 || mesh->radius <= 0.0f){
+    return 0;
+  }
+
+  vec3 centre = {0};
+  glm_mat4_mulv3(entity->trans, mesh->centre, 1.0f, centre);
+  glm_mat4_mulv3(camera->view, centre, 1.0f, centre);
+  float scale = MAX(glm_vec3_norm(entity->trans[0]),
+                    MAX(glm_vec3_norm(entity->trans[1]),
+                        glm_vec3_norm(entity->trans[2])));
+  float radius = mesh->radius * scale;
+  float distance = glm_vec3_norm(centre);
+  if(distance <= radius){
+    return 0; /* the camera's inside it */
+  }
+  /* the diameter over the screen's height, with a perspective proj */
+  float size = radius * camera->proj[1][1] / distance;
+
+  uint32_t lod = MIN(entity->lod, mesh->lodCount - 1);
+  while(lod > 0 && mesh->lods[lod].error * size > HG_LOD_SCREEN_ERROR){
+    lod--;
+  }
+  while(lod + 1 < mesh->lodCount
+        && mesh->lods[lod + 1].error * size * (1.0f + HG_LOD_HYSTERESIS)
+           <= HG_LOD_SCREEN_ERROR){
+    lod++;
+  }
+  return lod;
+}
+
 void hgDrawEntity(HgEntity *entity, HgLight *light, HgCamera *camera){
   
   hgUniformVec3(&meshShader,"uAmbient", light->ambient);
   hgUniformVec3(&meshShader,"uLightPos", light->position);
   hgUniformVec3(&meshShader,"uLightColor", light->color);
   
+  /* compact positions are 0-1 across the mesh's bounds, scaled back out
+   * here, so the shader reads every layout the same */
+  HgVertexBuffer *vb = &entity->mesh->vb;
+  mat4 model = {0};
+  if(vb->layout == HG_VERTEX_COMPACT){
+    mat4 dequant = {0};
+    glm_translate_make(dequant, vb->posOffset);
+    glm_scale(dequant, vb->posScale);
+    glm_mat4_mul(entity->trans, dequant, model);
+  }else{
+    glm_mat4_copy(entity->trans, model);
+  }
+
   mat4 mvp = {0};
 
   glm_mat4_identity(mvp);
   glm_mat4_mul(camera->proj, camera->view, mvp);
-  glm_mat4_mul(mvp, entity->trans, mvp);
+  glm_mat4_mul(mvp, model, mvp);
 
   mat3 normMat = {0};
 
@@ -28,16 +83,20 @@ void hgDrawEntity(HgEntity *entity, HgLight *light, HgCamera *camera){
   glm_mat3_inv(normMat, normMat);
 
   hgUniformMat4(&meshShader, "uMVP", false, mvp);
-  hgUniformMat4(&meshShader, "uTrans", false, entity->trans);
+  hgUniformMat4(&meshShader, "uTrans", false, model);
   hgUniformMat3(&meshShader, "uNormMat", true, normMat);
 
   hgBindTexture(&entity->mesh->t, 0);
   hgUniformInt(&meshShader, "uTexture", 0);
 
-  hgBindVertexBuffer(&entity->mesh->vb, &meshShader);
+  hgBindVertexBuffer(vb, &meshShader);
 
+  entity->lod = hgSelectLod(entity, camera);
+  const HgMeshLod *lod = &entity->mesh->lods[entity->lod];
+  uint32_t indSize = (vb->indexType == GL_UNSIGNED_INT) ? sizeof(uint32_t)
+                                                        : sizeof(uint16_t);
   GL_CALL(glDrawElements(GL_TRIANGLES,
-                         entity->mesh->vb.count,
-                         GL_UNSIGNED_SHORT, 
-                         NULL));
+                         lod->indCount,
+                         vb->indexType,
+                         (const void*)((uintptr_t)lod->indStart * indSize)));
 }
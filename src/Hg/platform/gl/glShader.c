@@ -8,9 +8,9 @@
 
 #include <alloca.h>
 
-uint32_t hgCompileShader(uint32_t type, const char* src){
+uint32_t hgCompileShader(uint32_t type, const char* src, int srcLength){
   GL_CALL(uint32_t id = glCreateShader(type));
-  GL_CALL(glShaderSource(id, 1, &src, NULL));
+  GL_CALL(glShaderSource(id, 1, &src, &srcLength));
   GL_CALL(glCompileShader(id));
 
   int result;
@@ -29,35 +29,88 @@ uint32_t hgCompileShader(uint32_t type, const char* src){
   return id;
 }
 
+/* Maps one stage's source, from its hgbake bake if that's up to date.
+ * text and length are the GLSL in the mapping */
+HgFileMap hgMapShader(HgArena *arena,
+                      const char *file,
+                      const char *bakeExtension,
+                      const char **text,
+                      int *length){
+  char bakeFile[PATH_LENGTH];
+  HgFileMap map = {0};
+  if(hgBakePath(bakeFile, PATH_LENGTH, file, bakeExtension) == 0
+     && hgFileExists(bakeFile)){
+    map = hgMapFileEx(arena, bakeFile);
+  }
+  if(map.data != NULL){
+    const HgShaderHeader *header = (const HgShaderHeader*)map.data;
+    bool isUsable = map.size >= sizeof(HgShaderHeader)
+                    && header->magic == HG_SHADER_MAGIC
+                    && header->version == HG_SHADER_VERSION
+                    && header->sourceCount <= HG_SHADER_MAX_SOURCES
+                    && header->textSize <= map.size - sizeof(HgShaderHeader);
+    for(uint32_t i = 0; isUsable && i < header->sourceCount; i++){
+      isUsable = hgIsBakeSourceFresh(&header->sources[i]);
+    }
+    if(isUsable){
+      *text = map.data + sizeof(HgShaderHeader);
+      *length = (int)header->textSize;
+      return map;
+    }
+    HG_LOG("Baked shader %s is stale, using %s", bakeFile, file);
+    hgUnmapFile(&map);
+  }
+
+  map = hgMapFileEx(arena, file);
+  *text = map.data;
+  *length = (int)map.size;
+  return map;
+}
+
 HgShader hgCreateShader(HgArena *arena, const char *file){
 
   char vertFile[PATH_LENGTH];
   char fragFile[PATH_LENGTH];
   snprintf(vertFile, PATH_LENGTH, "res/shaders/%s.vert", file);
   snprintf(fragFile, PATH_LENGTH, "res/shaders/%s.frag", file);
+  const char *vertText = NULL;
+  const char *fragText = NULL;
+  int vertLength = 0;
+  int fragLength = 0;
 
   HgShader sp = {0};
   GL_CALL(sp.program = glCreateProgram());
  
-  size_t vertSize = hgGetFileSize(vertFile);
-  size_t fragSize = hgGetFileSize(fragFile);
-
-  char *vertSrc = hgArenaPush(arena, vertSize);
-  char *fragSrc = hgArenaPush(arena, fragSize);
-
-  hgGetFileStr(vertSrc, vertSize, vertFile); 
-  hgGetFileStr(fragSrc, fragSize, fragFile); 
+  /* Sources are used straight from the files, only compressed pak
+   * entries are decoded onto the arena */
+  const char *oldTag = hgArenaSetTag(arena, "shader");
+  HgArenaMark mark = hgArenaGetMark(arena);
+  HgFileMap vertMap = hgMapShader(arena, vertFile, ".hgvert",
+                                  &vertText, &vertLength);
+  HgFileMap fragMap = hgMapShader(arena, fragFile, ".hgfrag",
+                                  &fragText, &fragLength);
+  if(vertMap.data == NULL || fragMap.data == NULL){
+    hgUnmapFile(&vertMap);
+    hgUnmapFile(&fragMap);
+    hgArenaPopToMark(arena, mark);
+    hgArenaSetTag(arena, oldTag);
+    GL_CALL(glDeleteProgram(sp.program));
+    sp.program = 0;
+    return sp;
+  }
 
-  uint32_t vs = hgCompileShader(GL_VERTEX_SHADER, vertSrc);
-  uint32_t fs = hgCompileShader(GL_FRAGMENT_SHADER, fragSrc);
+  uint32_t vs = hgCompileShader(GL_VERTEX_SHADER, vertText, vertLength);
+  uint32_t fs = hgCompileShader(GL_FRAGMENT_SHADER, fragText, fragLength);
 
   GL_CALL(glAttachShader(sp.program, vs));
   GL_CALL(glAttachShader(sp.program, fs));
   GL_CALL(glLinkProgram(sp.program));
   GL_CALL(glValidateProgram(sp.program));
 
-  hgArenaPop(arena, fragSrc, fragSize);
-  hgArenaPop(arena, vertSrc, vertSize);
+  hgUnmapFile(&vertMap);
+  hgUnmapFile(&fragMap);
+  hgArenaPopToMark(arena, mark);
+  hgArenaSetTag(arena, oldTag);
 
   GL_CALL(glDeleteShader(vs));
   GL_CALL(glDeleteShader(fs));
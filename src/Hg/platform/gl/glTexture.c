@@ -15,14 +15,114 @@ void hgUnbindTexture(void){
   GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
 }
 
+/* A new texture, bound. Nearest filtering, mipmapped so far away surfaces
+ * don't shimmer */
+void hgCreateTexture(HgTexture *t){
+  GL_CALL(glGenTextures(1, &t->id));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, t->id));
+
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D,
+                          GL_TEXTURE_MIN_FILTER,
+                          GL_NEAREST_MIPMAP_NEAREST));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+}
+
+/* Every mip of a baked .hgtex, straight from the mapping. Returns false if
+ * there's no bake, or it's stale */
+bool hgLoadBakedTexture(HgTexture *t, const char *bakeFile){
+  if(!hgFileExists(bakeFile)){
+    return false;
+  }
+  HgFileMap texMap = hgMapFile(bakeFile);
+  if(texMap.data == NULL){
+    return false;
+  }
+
+  const HgTexHeader *header = (const HgTexHeader*)texMap.data;
+  bool isUsable = texMap.size >= sizeof(HgTexHeader)
+                  && header->magic == HG_TEX_MAGIC
+                  && header->version == HG_TEX_VERSION
+                  && header->width > 0
+                  && header->height > 0
+                  && header->mipCount > 0
+                  && header->mipCount <= HG_TEX_MAX_MIPS;
+  /* every mip down to 1x1 is there, and in bounds */
+  uint64_t width = isUsable ? header->width : 0;
+  uint64_t height = isUsable ? header->height : 0;
+  for(uint32_t i = 0; isUsable && i < header->mipCount; i++){
+    isUsable = header->mipOffsets[i] <= texMap.size
+               && width * height * 4 <= texMap.size - header->mipOffsets[i];
+    if(i + 1 == header->mipCount){
+      isUsable = isUsable && width == 1 && height == 1;
+    }
+    width = MAX(width / 2, 1);
+    height = MAX(height / 2, 1);
+  }
+  if(!isUsable){
+    HG_WARN("Bad baked texture %s, using the image", bakeFile);
+  }else if(!hgIsBakeSourceFresh(&header->source)){
+    HG_LOG("Baked texture %s is stale, using the image", bakeFile);
+    isUsable = false;
+  }
+  if(!isUsable){
+    hgUnmapFile(&texMap);
+    return false;
+  }
+
+  t->width = (int)header->width;
+  t->height = (int)header->height;
+  t->bpp = 4;
+  hgCreateTexture(t);
+  width = header->width;
+  height = header->height;
+  for(uint32_t i = 0; i < header->mipCount; i++){
+    GL_CALL(glTexImage2D(GL_TEXTURE_2D,
+                         (int)i,
+                         GL_RGBA,
+                         (int)width,
+                         (int)height,
+                         0,
+                         GL_RGBA,
+                         GL_UNSIGNED_BYTE,
+                         texMap.data + header->mipOffsets[i]));
+    width = MAX(width / 2, 1);
+    height = MAX(height / 2, 1);
+  }
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+
+  hgUnmapFile(&texMap);
+  return true;
+}
+
 void hgLoadMeshTexture(HgMesh *mesh, char *file){
   uint8_t *buffer;
 
   char path[PATH_LENGTH];
+  char bakeFile[PATH_LENGTH];
   snprintf(path, PATH_LENGTH, "res/models/%s", file);
 
+  /* the bake from hgbake is ready to upload, no image decoding */
+  if(hgBakePath(bakeFile, PATH_LENGTH, path, ".hgtex") == 0
+     && hgLoadBakedTexture(&mesh->t, bakeFile)){
+    return;
+  }
+
+  /* Through hgMapFile, so textures in the .hgpak are found */
+  HgFileMap texMap = hgMapFile(path);
+  if(texMap.data == NULL){
+    return;
+  }
+
   stbi_set_flip_vertically_on_load(1);
-  buffer = stbi_load(path, &mesh->t.width, &mesh->t.height, &mesh->t.bpp, 4);
+  buffer = stbi_load_from_memory((const stbi_uc*)texMap.data,
+                                 (int)texMap.size,
+                                 &mesh->t.width,
+                                 &mesh->t.height,
+                                 &mesh->t.bpp,
+                                 4);
+  hgUnmapFile(&texMap);
 
   if(!buffer){
     HG_ERROR("Failed to load Texture: %s", file);
@@ -30,13 +130,7 @@ void hgLoadMeshTexture(HgMesh *mesh, char *file){
   }
 
 
-  GL_CALL(glGenTextures(1, &mesh->t.id));
-  GL_CALL(glBindTexture(GL_TEXTURE_2D, mesh->t.id));
-
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+  hgCreateTexture(&mesh->t);
 
   GL_CALL(glTexImage2D(GL_TEXTURE_2D, 
                        0,
@@ -47,6 +141,7 @@ void hgLoadMeshTexture(HgMesh *mesh, char *file){
                        GL_RGBA,
                        GL_UNSIGNED_BYTE,
                        buffer));
+  GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
 
   GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
   
@@ -6,24 +6,64 @@
  *  Purpose: Handles model vertex data (vertex buffers in OpenGL)
  */
 
-void setupAttrib(uint32_t index, int size, int position){
+/* GLES3, the GLES2 loader doesn't have it */
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+
+/* Where one attribute is in a vertex, and what it's stored as */
+typedef struct HgVertexAttrib {
+  int size;
+  uint32_t type;
+  bool isNormalized;  /* integers read as 0-1 (or -1-1 if signed) */
+  uint32_t offset;
+}HgVertexAttrib;
+
+typedef struct HgVertexLayout {
+  uint32_t stride;
+  HgVertexAttrib position;
+  HgVertexAttrib normal;
+  HgVertexAttrib texture;
+}HgVertexLayout;
+
+/* Every layout reads into the same vec3/vec2 attributes, so the shader
+ * doesn't care which one a mesh is in */
+const HgVertexLayout hgVertexLayouts[HG_VERTEX_LAYOUT_COUNT] = {
+  [HG_VERTEX_FLOAT] = {
+    sizeof(HgVertex),
+    {3, GL_FLOAT, false, offsetof(HgVertex, position)},
+    {3, GL_FLOAT, false, offsetof(HgVertex, normal)},
+    {2, GL_FLOAT, false, offsetof(HgVertex, texture)}
+  },
+  [HG_VERTEX_COMPACT] = {
+    sizeof(HgCompactVertex),
+    {3, GL_UNSIGNED_SHORT, true, offsetof(HgCompactVertex, position)},
+    {3, GL_BYTE, true, offsetof(HgCompactVertex, normal)},
+    {2, GL_HALF_FLOAT, false, offsetof(HgCompactVertex, texture)}
+  }
+};
+
+void setupAttrib(uint32_t index,
+                 const HgVertexAttrib *attrib,
+                 uint32_t stride){
   GL_CALL(glEnableVertexAttribArray(index)); 
   GL_CALL(glVertexAttribPointer(index,
-                                size,
-                                GL_FLOAT,
-                                GL_FALSE,
-                                sizeof(HgVertex),
-                                (const void*)(position * sizeof(float)))); 
+                                attrib->size,
+                                attrib->type,
+                                attrib->isNormalized ? GL_TRUE : GL_FALSE,
+                                stride,
+                                (const void*)(uintptr_t)attrib->offset)); 
 }
 
-void setupAllAttribs(HgShader *sp){
+void setupAllAttribs(HgShader *sp, uint32_t layout){
   int posLoc = glGetAttribLocation(sp->program,"aPosition");
   int normLoc = glGetAttribLocation(sp->program,"aNormal");
   int texLoc = glGetAttribLocation(sp->program,"aTexCoord");
 
-  setupAttrib(posLoc, 3, 0);
-  setupAttrib(normLoc, 3, 3);
-  setupAttrib(texLoc, 2, 6);
+  const HgVertexLayout *vertexLayout = &hgVertexLayouts[layout];
+  setupAttrib(posLoc, &vertexLayout->position, vertexLayout->stride);
+  setupAttrib(normLoc, &vertexLayout->normal, vertexLayout->stride);
+  setupAttrib(texLoc, &vertexLayout->texture, vertexLayout->stride);
 
 }
 
@@ -31,7 +71,7 @@ void hgBindVertexBuffer(HgVertexBuffer *vb, HgShader *sp){
   GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, vb->vbo));
   GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vb->ibo));
   
-  setupAllAttribs(sp);
+  setupAllAttribs(sp, vb->layout);
 }
 
 void hgUnbindVertexBuffer(void){
@@ -39,16 +79,39 @@ void hgUnbindVertexBuffer(void){
   GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
 }
 
-void hgCreateMeshVertexBuffer(HgMesh *mesh,
-                              HgVertex* data,
-                              uint32_t vertCount,
-                              uint16_t* inds,
-                              uint32_t indCount){
+void hgCreateMeshVertexBufferEx(HgMesh *mesh,
+                                const void* data,
+                                uint32_t layout,
+                                uint32_t vertCount,
+                                const void* inds,
+                                uint32_t indCount,
+                                uint32_t indSize,
+                                const vec3 boundsMin,
+                                const vec3 boundsMax){
   
 
   mesh->vb.ibo = 0;
   mesh->vb.vbo = 0;
   mesh->vb.count = indCount;
+  mesh->vb.indexType = (indSize == sizeof(uint32_t)) ? GL_UNSIGNED_INT
+                                                     : GL_UNSIGNED_SHORT;
+  mesh->vb.layout = (layout < HG_VERTEX_LAYOUT_COUNT) ? layout
+                                                      : HG_VERTEX_FLOAT;
+  bool isCompact = (mesh->vb.layout == HG_VERTEX_COMPACT);
+  bool isBounded = (boundsMin != NULL && boundsMax != NULL);
+  float radius = 0.0f;
+  for(int i = 0; i < 3; i++){
+    float half = isBounded ? (boundsMax[i] - boundsMin[i]) * 0.5f : 0.0f;
+    mesh->vb.posOffset[i] = isCompact ? boundsMin[i] : 0.0f;
+    mesh->vb.posScale[i] = isCompact ? 2.0f * half : 1.0f;
+    mesh->centre[i] = isBounded ? boundsMin[i] + half : 0.0f;
+    radius += half * half;
+  }
+  mesh->radius = sqrtf(radius);
+  mesh->lods[0].indStart = 0;
+  mesh->lods[0].indCount = indCount;
+  mesh->lods[0].error = 0.0f;
+  mesh->lodCount = 1;
 
   GL_CALL(glGenBuffers(1, &mesh->vb.ibo));
   GL_CALL(glGenBuffers(1, &mesh->vb.vbo));
@@ -56,17 +119,46 @@ void hgCreateMeshVertexBuffer(HgMesh *mesh,
   hgBindVertexBuffer(&mesh->vb, &meshShader);
 
   GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                       indCount * sizeof(uint16_t),
+                       (size_t)indCount * indSize,
                        inds,
                        GL_STATIC_DRAW));
 
   GL_CALL(glBufferData(GL_ARRAY_BUFFER,
-                       vertCount * sizeof(HgVertex),
+                       (size_t)vertCount * hgVertexSize(mesh->vb.layout),
                        data, GL_STATIC_DRAW));
 
   hgUnbindVertexBuffer();
 }
 
+void hgCreateMeshVertexBuffer(HgMesh *mesh,
+                              HgVertex* data,
+                              uint32_t vertCount,
+                              const void* inds,
+                              uint32_t indCount,
+                              uint32_t indSize){
+  hgCreateMeshVertexBufferEx(mesh, data, HG_VERTEX_FLOAT, vertCount,
+                             inds, indCount, indSize, NULL, NULL);
+}
+
+void hgSetMeshLods(HgMesh *mesh, const HgMeshLod *lods, uint32_t lodCount){
+  mesh->lodCount = 0;
+  for(uint32_t i = 0; i < lodCount && i < HG_MESH_MAX_LODS; i++){
+    if(lods[i].indStart > mesh->vb.count
+       || lods[i].indCount > mesh->vb.count - lods[i].indStart){
+      HG_WARN("LOD %u is past the mesh's indices, not using it", i);
+      break;
+    }
+    mesh->lods[mesh->lodCount++] = lods[i];
+  }
+  /* always something to draw */
+  if(mesh->lodCount == 0){
+    mesh->lods[0].indStart = 0;
+    mesh->lods[0].indCount = mesh->vb.count;
+    mesh->lods[0].error = 0.0f;
+    mesh->lodCount = 1;
+  }
+}
+
 void hgCleanupVertexBuffer(HgVertexBuffer *vb){
   //hgArenaPop(arena, vb, sizeof(HgVertexBuffer));
   GL_CALL(glDeleteBuffers(1, &vb->vbo));
@@ -0,0 +1,113 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: What every baked file shares, and the baked texture (.hgtex)
+ *  and shader (.hgvert/.hgfrag) formats. Meshes are in hgmesh.h. Shared by
+ *  the engine and the hgbake tool.
+ *
+ *  A baked file sits next to the file it was made from, with an extension
+ *  added (see hgBakePath), and keeps a stamp of every file it was made
+ *  from. A bake whose sources changed is stale, the engine uses the
+ *  sources instead until it's redone.
+ *
+ *  .hgtex layout:
+ *    HgTexHeader
+ *    mips         RGBA8, bottom row first (what glTexImage2D wants), from
+ *                 the full size down to 1x1, each HG_BAKE_ALIGN aligned
+ *
+ *  .hgvert/.hgfrag layout:
+ *    HgShaderHeader
+ *    text         the source with #include "file" resolved, and comments
+ *                 and blank lines removed
+ *
+ *  All numbers are little endian.
+ */
+
+#ifndef HGBAKE_H
+#define HGBAKE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define HG_TEX_MAGIC 0x58544748    /* "HGTX" */
+#define HG_TEX_VERSION 1
+#define HG_SHADER_MAGIC 0x52534748 /* "HGSR" */
+#define HG_SHADER_VERSION 1
+
+/* Blob alignment, a page so blobs map on their own pages */
+#define HG_BAKE_ALIGN 4096
+
+#define HG_BAKE_PATH_LENGTH 256
+
+/* Most mips in a .hgtex, enough for 32768x32768 */
+#define HG_TEX_MAX_MIPS 16
+
+/* Most files one shader can be made from, with its includes */
+#define HG_SHADER_MAX_SOURCES 8
+
+/* A file a bake was made from */
+typedef struct HgBakeSource {
+  char path[HG_BAKE_PATH_LENGTH]; /* "" if there was none */
+  uint64_t size;
+  int64_t modTime;                /* hgFileModTime (st_mtime) when baked */
+  uint64_t hash;                  /* hgBakeHash of the contents */
+}HgBakeSource;
+
+typedef struct HgTexHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t mipCount;
+  uint32_t padding;
+  uint64_t mipOffsets[HG_TEX_MAX_MIPS]; /* from the start of the file */
+  HgBakeSource source;
+}HgTexHeader;
+
+typedef struct HgShaderHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t sourceCount;
+  uint32_t textSize;  /* bytes of text after the header, no terminator */
+  HgBakeSource sources[HG_SHADER_MAX_SOURCES]; /* the shader, then includes */
+}HgShaderHeader;
+
+/* Hash of a file's contents, 8 bytes at a time so checking a stale bake
+ * costs much less than redoing it */
+uint64_t hgBakeHash(const void* data, uint64_t size){
+  const uint8_t *bytes = (const uint8_t*)data;
+  uint64_t hash = 0xcbf29ce484222325ull ^ size;
+  uint64_t i = 0;
+  for(; i + 8 <= size; i += 8){
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3ull;
+    hash ^= hash >> 29;
+  }
+  for(; i < size; i++){
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  hash ^= hash >> 32;
+  hash *= 0xd6e8feb86659fd93ull;
+  return hash ^ (hash >> 32);
+}
+
+/* Where the bake of path goes, i.e: "res/models/red.png" and ".hgtex" is
+ * "res/models/red.png.hgtex". The source's extension stays, so red.png and
+ * red.jpg don't share a bake. Returns -1 if it doesn't fit */
+int hgBakePath(char* bakePath,
+               uint64_t size,
+               const char* path,
+               const char* extension){
+  uint64_t pathLength = strlen(path);
+  if(pathLength + strlen(extension) + 1 > size){
+    return -1;
+  }
+  memcpy(bakePath, path, pathLength);
+  strcpy(bakePath + pathLength, extension);
+  return 0;
+}
+
+#endif /* HGBAKE_H */
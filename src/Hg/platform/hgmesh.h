@@ -0,0 +1,67 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: The .hgmesh baked mesh format, every object of one .obj file
+ *  ready for the GPU, LODs included. Written by objLoad.c (in the engine,
+ *  or the hgbake tool), and loaded by mapping it and handing the blobs
+ *  straight to hgCreateMeshVertexBufferEx.
+ *
+ *  Layout:
+ *    HgMeshHeader
+ *    blobs                   each mesh's verts, then its indices, every
+ *                            blob starts HG_MESH_ALIGN aligned
+ *    HgMeshEntry[meshCount]  at entriesOffset, in file order
+ *
+ *  All numbers are little endian. The header keeps a stamp of the .obj and
+ *  .mtl it came from (see hgbake.h), so a stale bake can be found and
+ *  redone.
+ */
+
+#ifndef HGMESH_H
+#define HGMESH_H
+
+#include <stdint.h>
+
+#include "hgbake.h"
+
+#define HG_MESH_MAGIC 0x48534d48 /* "HMSH" */
+#define HG_MESH_VERSION 3
+
+#define HG_MESH_ALIGN HG_BAKE_ALIGN
+
+#define HG_MESH_NAME_LENGTH 64
+#define HG_MESH_PATH_LENGTH HG_BAKE_PATH_LENGTH
+
+/* HgMeshHeader flags */
+#define HG_MESH_COMPACT 0x1 /* baked in HG_VERTEX_COMPACT, rebake it that way */
+
+typedef struct HgMeshHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t meshCount;
+  uint32_t flags;
+  uint64_t entriesOffset;
+  HgBakeSource obj;
+  HgBakeSource mtl;
+}HgMeshHeader;
+
+typedef struct HgMeshEntry {
+  char name[HG_MESH_NAME_LENGTH];    /* 'o' object name */
+  char texture[HG_MESH_PATH_LENGTH]; /* map_Kd of its material, or "" */
+  uint32_t layout;                   /* HG_VERTEX_FLOAT or HG_VERTEX_COMPACT */
+  uint32_t vertSize;                 /* bytes per vertex */
+  uint32_t vertCount;
+  uint32_t indSize;                  /* 2 or 4 */
+  uint32_t indCount;                 /* every LOD's */
+  uint32_t lodCount;
+  HgMeshLod lods[HG_MESH_MAX_LODS];  /* ranges of the indices */
+  uint32_t padding;
+  float boundsMin[3];                /* compact positions are across these */
+  float boundsMax[3];
+  uint64_t vertOffset;               /* from the start of the file */
+  uint64_t indOffset;
+}HgMeshEntry;
+
+#endif /* HGMESH_H */
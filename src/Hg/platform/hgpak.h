@@ -0,0 +1,151 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: The .hgpak asset archive format. Shared by the engine (file.c)
+ *  and the hgpak packing tool.
+ *
+ *  Layout:
+ *    HgPakHeader
+ *    HgPakEntry[bucketCount]  hash table of entries, by hash of the name
+ *    names                    null terminated, i.e: "res/models/cube.obj"
+ *    data                     each entry starts HG_PAK_ALIGN aligned
+ *
+ *  All numbers are little endian. The archive is mapped once and used in
+ *  place, entries are never copied out unless they are compressed.
+ *
+ *  Compressed entries (HG_PAK_COMPRESSED) are split into chunks of
+ *  HG_PAK_CHUNK_SIZE raw bytes, so they can be decoded in parallel:
+ *    HgPakChunks
+ *    uint64_t offsets[chunkCount + 1]  from the start of the entry data
+ *    chunks                            each an LZ4 block
+ */
+
+#ifndef HGPAK_H
+#define HGPAK_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define HG_PAK_MAGIC 0x4b415048 /* "HPAK" */
+#define HG_PAK_VERSION 1
+
+/* Entry data alignment, so it can be used straight from the mapping */
+#define HG_PAK_ALIGN 64
+
+/* HgPakEntry flags */
+#define HG_PAK_COMPRESSED (1 << 0)
+
+/* Raw bytes in each chunk of a compressed entry (the last can be less) */
+#define HG_PAK_CHUNK_SIZE (256 * 1024)
+
+typedef struct HgPakHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t bucketCount; /* power of 2, at least twice entryCount */
+}HgPakHeader;
+
+typedef struct HgPakEntry {
+  uint64_t hash;       /* hgPakHash of the name, 0 for an empty bucket */
+  uint64_t offset;     /* data offset from the start of the archive */
+  uint64_t size;       /* size of the data in the archive */
+  uint64_t rawSize;    /* size of the data once decompressed */
+  uint32_t nameOffset; /* name offset from the start of the archive */
+  uint32_t flags;
+}HgPakEntry;
+
+/* Start of a compressed entry's data */
+typedef struct HgPakChunks {
+  uint32_t chunkCount;
+  uint32_t chunkSize;  /* raw bytes per chunk */
+}HgPakChunks;
+
+/* FNV-1a, never 0 so 0 can mark empty buckets */
+uint64_t hgPakHash(const char* name){
+  uint64_t hash = 0xcbf29ce484222325ull;
+  while(*name){
+    hash ^= (uint8_t)*name++;
+    hash *= 0x100000001b3ull;
+  }
+  return (hash == 0) ? 1 : hash;
+}
+
+/* Decode one LZ4 block (the raw block format, no frame) into exactly
+ * dstSize bytes. Checks every length, so a corrupt archive fails instead of
+ * writing out of bounds. Returns 0 on success */
+int hgPakDecodeBlock(const uint8_t* src,
+                     uint64_t srcSize,
+                     uint8_t* dst,
+                     uint64_t dstSize){
+  const uint8_t *in = src;
+  const uint8_t *inEnd = src + srcSize;
+  uint8_t *out = dst;
+  uint8_t *outEnd = dst + dstSize;
+
+  while(in < inEnd){
+    uint8_t token = *in++;
+
+    /* literals */
+    uint64_t length = token >> 4;
+    if(length == 15){
+      uint8_t extra;
+      do{
+        if(in >= inEnd){
+          return -1;
+        }
+        extra = *in++;
+        length += extra;
+      }while(extra == 255);
+    }
+    if(length > (uint64_t)(inEnd - in) || length > (uint64_t)(outEnd - out)){
+      return -1;
+    }
+    memcpy(out, in, length);
+    in += length;
+    out += length;
+
+    /* the last sequence is only literals */
+    if(in == inEnd){
+      break;
+    }
+
+    /* match */
+    if(inEnd - in < 2){
+      return -1;
+    }
+    uint64_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    if(offset == 0 || offset > (uint64_t)(out - dst)){
+      return -1;
+    }
+    length = (token & 15) + 4;
+    if((token & 15) == 15){
+      uint8_t extra;
+      do{
+        if(in >= inEnd){
+          return -1;
+        }
+        extra = *in++;
+        length += extra;
+      }while(extra == 255);
+    }
+    if(length > (uint64_t)(outEnd - out)){
+      return -1;
+    }
+    const uint8_t *match = out - offset;
+    if(offset >= length){
+      memcpy(out, match, length);
+      out += length;
+    }else{
+      /* overlapping, repeats the last offset bytes */
+      while(length--){
+        *out++ = *match++;
+      }
+    }
+  }
+  return (out == outEnd) ? 0 : -1;
+}
+
+#endif /* HGPAK_H */
@@ -0,0 +1,603 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: Builds a mesh's levels of detail, simpler versions of it drawn
+ *  when it's small on screen. Used by objLoad.c after meshOpt.c, so meshes
+ *  get LODs both when they're parsed at runtime and from hgbake.
+ *
+ *  Edges are collapsed cheapest first. The cost is how far the vertex that
+ *  moves would be from the planes of every triangle it has taken in so far
+ *  (Garland and Heckbert, "Surface Simplification Using Quadric Error
+ *  Metrics", 1997). A vertex only ever moves onto a neighbour, so every LOD
+ *  is just more indices into the same vertices. Vertices split by a uv or
+ *  normal seam never move, so seams can't tear, and vertices on an open
+ *  border only move along it.
+ */
+
+/* Biggest error a LOD can have, over the mesh's diameter */
+#define HG_LOD_MAX_ERROR 0.05f
+
+/* Each LOD aims for this much of the last one's triangles */
+#define HG_LOD_RATIO 0.5f
+
+/* A LOD that can't get under this much of the last one isn't worth it */
+#define HG_LOD_MIN_SAVING 0.75f
+
+/* Smallest triangle count worth making a LOD of */
+#define HG_LOD_MIN_TRIANGLES 32
+
+/* How much more the planes along open borders count than the surface, so
+ * borders keep their shape */
+#define HG_LOD_BORDER_WEIGHT 10.0
+
+/* Buckets collapses are sorted into, by the top bits of their error */
+#define HG_LOD_SORT_BITS 11
+#define HG_LOD_SORT_BUCKETS (1 << HG_LOD_SORT_BITS)
+
+/* How a vertex can move */
+#define HG_LOD_MANIFOLD 0 /* onto any neighbour */
+#define HG_LOD_BORDER 1   /* along an open border, onto the next vertex */
+#define HG_LOD_LOCKED 2   /* never, it's on a seam or it's too tangled */
+
+/* Sum of squared distances to planes, area weighted. For a point p it's
+ * p.A.p + 2 b.p + c, A is symmetric so only 6 of it is kept */
+typedef struct HgLodQuadric {
+  double a00, a01, a02, a11, a12, a22;
+  double b0, b1, b2;
+  double c;
+  double area;
+}HgLodQuadric;
+
+/* The plane n.p + d = 0, n is unit length */
+void hgLodQuadricAddPlane(HgLodQuadric *q,
+                          const double n[3],
+                          double d,
+                          double weight){
+  q->a00 += weight * n[0] * n[0];
+  q->a01 += weight * n[0] * n[1];
+  q->a02 += weight * n[0] * n[2];
+  q->a11 += weight * n[1] * n[1];
+  q->a12 += weight * n[1] * n[2];
+  q->a22 += weight * n[2] * n[2];
+  q->b0 += weight * n[0] * d;
+  q->b1 += weight * n[1] * d;
+  q->b2 += weight * n[2] * d;
+  q->c += weight * d * d;
+}
+
+void hgLodQuadricAdd(HgLodQuadric *q, const HgLodQuadric *other){
+  q->a00 += other->a00;
+  q->a01 += other->a01;
+  q->a02 += other->a02;
+  q->a11 += other->a11;
+  q->a12 += other->a12;
+  q->a22 += other->a22;
+  q->b0 += other->b0;
+  q->b1 += other->b1;
+  q->b2 += other->b2;
+  q->c += other->c;
+  q->area += other->area;
+}
+
+/* Average squared distance from p to the quadric's planes */
+double hgLodQuadricError(const HgLodQuadric *q, const float p[3]){
+  double x = p[0];
+  double y = p[1];
+  double z = p[2];
+  double error = q->a00 * x * x + q->a11 * y * y + q->a22 * z * z
+                 + 2.0 * (q->a01 * x * y + q->a02 * x * z + q->a12 * y * z)
+                 + 2.0 * (q->b0 * x + q->b1 * y + q->b2 * z)
+                 + q->c;
+  error = (q->area > 0.0) ? error / q->area : error;
+  return (error > 0.0) ? error : 0.0;
+}
+
+/* Where a vertex went, following every collapse since */
+uint32_t hgLodFind(uint32_t *collapsed, uint32_t v){
+  while(collapsed[v] != v){
+    collapsed[v] = collapsed[collapsed[v]];
+    v = collapsed[v];
+  }
+  return v;
+}
+
+/* The first vertex at each vertex's position, so vertices split by a seam
+ * are known to be the same point. Returns -1 if out of memory */
+int hgLodWeldPositions(HgArena *scratch,
+                       const HgVertex *verts,
+                       uint32_t vertCount,
+                       uint32_t *welded){
+  HgArenaMark mark = hgArenaGetMark(scratch);
+  uint64_t capacity = 1;
+  while(capacity < 2 * (uint64_t)vertCount){
+    capacity *= 2;
+  }
+  uint32_t *slots = hgArenaPush(scratch, capacity * sizeof(uint32_t));
+  if(slots == NULL){
+    return -1;
+  }
+  memset(slots, 0xff, capacity * sizeof(uint32_t));
+  for(uint32_t v = 0; v < vertCount; v++){
+    uint32_t bits[3];
+    memcpy(bits, verts[v].position, sizeof(bits));
+    uint64_t slot = (bits[0] * 0x9e3779b97f4a7c15ull
+                     ^ bits[1] * 0xc2b2ae3d27d4eb4full
+                     ^ bits[2] * 0x165667b19e3779f9ull);
+    slot = (slot ^ (slot >> 32)) & (capacity - 1);
+    while(slots[slot] != UINT32_MAX
+          && memcmp(verts[slots[slot]].position,
+                    verts[v].position, sizeof(vec3)) != 0){
+      slot = (slot + 1) & (capacity - 1);
+    }
+    if(slots[slot] == UINT32_MAX){
+      slots[slot] = v;
+    }
+    welded[v] = slots[slot];
+  }
+  hgArenaPopToMark(scratch, mark);
+  return 0;
+}
+
+/* The triangles around each position, tris[offsets[p]] to
+ * tris[offsets[p + 1]] for p = welded[v]. Vertices that can move aren't
+ * split, so for them it's just their own triangles */
+void hgLodAdjacency(const uint32_t *inds,
+                    uint32_t triCount,
+                    const uint32_t *welded,
+                    uint32_t vertCount,
+                    uint32_t *offsets,
+                    uint32_t *tris){
+  memset(offsets, 0, (vertCount + 1) * sizeof(uint32_t));
+  for(uint64_t i = 0; i < 3 * (uint64_t)triCount; i++){
+    offsets[welded[inds[i]] + 1]++;
+  }
+  for(uint32_t v = 0; v < vertCount; v++){
+    offsets[v + 1] += offsets[v];
+  }
+  for(uint64_t i = 0; i < 3 * (uint64_t)triCount; i++){
+    tris[offsets[welded[inds[i]]]++] = (uint32_t)(i / 3);
+  }
+  for(uint32_t v = vertCount; v > 0; v--){
+    offsets[v] = offsets[v - 1];
+  }
+  offsets[0] = 0;
+}
+
+/* Is the edge from a to b open, with no triangle on its other side? */
+bool hgLodIsOpenEdge(const uint32_t *inds,
+                     const uint32_t *offsets,
+                     const uint32_t *tris,
+                     const uint32_t *welded,
+                     uint32_t a,
+                     uint32_t b){
+  uint32_t at = welded[a];
+  for(uint32_t i = offsets[at]; i < offsets[at + 1]; i++){
+    const uint32_t *tri = &inds[3 * (uint64_t)tris[i]];
+    for(int corner = 0; corner < 3; corner++){
+      if(welded[tri[corner]] == welded[b]
+         && welded[tri[(corner + 1) % 3]] == welded[a]){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/* Twice the triangle's area long */
+void hgLodTriangleNormal(const float *p0,
+                         const float *p1,
+                         const float *p2,
+                         double n[3]){
+  double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+  double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+  n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+  n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+  n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+/* Every triangle's plane, and planes standing up along open borders, into
+ * the quadrics of their vertices. Marks how each vertex can move */
+void hgLodStartQuadrics(const HgVertex *verts,
+                        uint32_t vertCount,
+                        const uint32_t *inds,
+                        uint32_t triCount,
+                        const uint32_t *offsets,
+                        const uint32_t *tris,
+                        const uint32_t *welded,
+                        HgLodQuadric *quadrics,
+                        uint8_t *kinds){
+  memset(quadrics, 0, vertCount * sizeof(HgLodQuadric));
+  memset(kinds, HG_LOD_MANIFOLD, vertCount);
+
+  /* split vertices are on a seam */
+  for(uint32_t v = 0; v < vertCount; v++){
+    if(welded[v] != v){
+      kinds[v] = HG_LOD_LOCKED;
+      kinds[welded[v]] = HG_LOD_LOCKED;
+    }
+  }
+
+  /* locked vertices never move, so their quadrics go unused */
+  for(uint32_t t = 0; t < triCount; t++){
+    const uint32_t *tri = &inds[3 * (uint64_t)t];
+    if(kinds[tri[0]] == HG_LOD_LOCKED && kinds[tri[1]] == HG_LOD_LOCKED
+       && kinds[tri[2]] == HG_LOD_LOCKED){
+      continue;
+    }
+    double n[3];
+    hgLodTriangleNormal(verts[tri[0]].position,
+                        verts[tri[1]].position,
+                        verts[tri[2]].position, n);
+    double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if(length <= 0.0){
+      continue;
+    }
+    double area = length * 0.5;
+    for(int j = 0; j < 3; j++){
+      n[j] /= length;
+    }
+    const float *p0 = verts[tri[0]].position;
+    double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+    for(int corner = 0; corner < 3; corner++){
+      if(kinds[tri[corner]] != HG_LOD_LOCKED){
+        hgLodQuadricAddPlane(&quadrics[tri[corner]], n, d, area);
+        quadrics[tri[corner]].area += area;
+      }
+    }
+
+    for(int corner = 0; corner < 3; corner++){
+      uint32_t a = tri[corner];
+      uint32_t b = tri[(corner + 1) % 3];
+      if((kinds[a] == HG_LOD_LOCKED && kinds[b] == HG_LOD_LOCKED)
+         || !hgLodIsOpenEdge(inds, offsets, tris, welded, a, b)){
+        continue;
+      }
+      const float *pa = verts[a].position;
+      const float *pb = verts[b].position;
+      double edge[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+      double edgeLength = sqrt(edge[0] * edge[0] + edge[1] * edge[1]
+                               + edge[2] * edge[2]);
+      /* perpendicular to the triangle, through the edge */
+      double side[3] = {edge[1] * n[2] - edge[2] * n[1],
+                        edge[2] * n[0] - edge[0] * n[2],
+                        edge[0] * n[1] - edge[1] * n[0]};
+      double sideLength = sqrt(side[0] * side[0] + side[1] * side[1]
+                               + side[2] * side[2]);
+      if(sideLength > 0.0){
+        for(int j = 0; j < 3; j++){
+          side[j] /= sideLength;
+        }
+        double sideD = -(side[0] * pa[0] + side[1] * pa[1] + side[2] * pa[2]);
+        double weight = HG_LOD_BORDER_WEIGHT * edgeLength * edgeLength;
+        hgLodQuadricAddPlane(&quadrics[a], side, sideD, weight);
+        hgLodQuadricAddPlane(&quadrics[b], side, sideD, weight);
+      }
+      for(int end = 0; end < 2; end++){
+        uint32_t v = end ? b : a;
+        if(kinds[v] == HG_LOD_MANIFOLD){
+          kinds[v] = HG_LOD_BORDER;
+        }
+      }
+    }
+  }
+
+  /* a border vertex with more than one edge out is where borders meet */
+  for(uint32_t v = 0; v < vertCount; v++){
+    if(kinds[v] != HG_LOD_BORDER){
+      continue;
+    }
+    uint32_t outCount = 0;
+    for(uint32_t i = offsets[v]; i < offsets[v + 1]; i++){
+      const uint32_t *tri = &inds[3 * (uint64_t)tris[i]];
+      for(int corner = 0; corner < 3; corner++){
+        if(tri[corner] == v
+           && hgLodIsOpenEdge(inds, offsets, tris, welded,
+                              v, tri[(corner + 1) % 3])){
+          outCount++;
+        }
+      }
+    }
+    if(outCount != 1){
+      kinds[v] = HG_LOD_LOCKED;
+    }
+  }
+}
+
+/* A possible collapse, from moving onto to */
+typedef struct HgLodCollapse {
+  uint32_t from;
+  uint32_t to;
+  double error;
+}HgLodCollapse;
+
+/* The collapses in order of error, to within an eighth. Positive floats
+ * sort the same as their bits, so the exponent and first few bits of the
+ * mantissa are a bucket, and a counting sort is a lot quicker than qsort
+ * for the million or so collapses of a big mesh */
+void hgLodSortCollapses(const HgLodCollapse *collapses,
+                        uint64_t collapseCount,
+                        uint32_t *order){
+  uint32_t starts[HG_LOD_SORT_BUCKETS] = {0};
+  for(uint64_t i = 0; i < collapseCount; i++){
+    float error = (float)collapses[i].error;
+    uint32_t bits;
+    memcpy(&bits, &error, sizeof(bits));
+    starts[bits >> (31 - HG_LOD_SORT_BITS)]++;
+  }
+  uint32_t start = 0;
+  for(uint32_t b = 0; b < HG_LOD_SORT_BUCKETS; b++){
+    uint32_t count = starts[b];
+    starts[b] = start;
+    start += count;
+  }
+  for(uint64_t i = 0; i < collapseCount; i++){
+    float error = (float)collapses[i].error;
+    uint32_t bits;
+    memcpy(&bits, &error, sizeof(bits));
+    order[starts[bits >> (31 - HG_LOD_SORT_BITS)]++] = (uint32_t)i;
+  }
+}
+
+/* Would moving from onto to flip (or nearly flip) one of from's
+ * triangles? Triangles with both go away, so aren't checked. from can
+ * move, so it isn't split and its position's triangles are its own */
+bool hgLodIsFlip(const HgVertex *verts,
+                 const uint32_t *inds,
+                 const uint32_t *offsets,
+                 const uint32_t *tris,
+                 const uint8_t *isDead,
+                 uint32_t *collapsed,
+                 uint32_t from,
+                 uint32_t to){
+  for(uint32_t i = offsets[from]; i < offsets[from + 1]; i++){
+    uint32_t t = tris[i];
+    if(isDead[t]){
+      continue;
+    }
+    uint32_t tri[3];
+    for(int corner = 0; corner < 3; corner++){
+      tri[corner] = hgLodFind(collapsed, inds[3 * (uint64_t)t + corner]);
+    }
+    if(tri[0] == to || tri[1] == to || tri[2] == to){
+      continue;
+    }
+    const float *p[3];
+    for(int corner = 0; corner < 3; corner++){
+      p[corner] = verts[tri[corner]].position;
+    }
+    double before[3];
+    hgLodTriangleNormal(p[0], p[1], p[2], before);
+    for(int corner = 0; corner < 3; corner++){
+      p[corner] = (tri[corner] == from) ? verts[to].position : p[corner];
+    }
+    double after[3];
+    hgLodTriangleNormal(p[0], p[1], p[2], after);
+    double dot = before[0] * after[0] + before[1] * after[1]
+                 + before[2] * after[2];
+    double lengths = sqrt((before[0] * before[0] + before[1] * before[1]
+                           + before[2] * before[2])
+                          * (after[0] * after[0] + after[1] * after[1]
+                             + after[2] * after[2]));
+    /* turning more than about 75 degrees */
+    if(dot <= 0.25 * lengths){
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Builds up to HG_MESH_MAX_LODS - 1 simpler versions of the mesh, each
+ * with about HG_LOD_RATIO of the last one's triangles, into lodInds one
+ * after another. lods[0] is the full mesh (inds), the others' indStart is
+ * where they'd be with lodInds put right after inds. Each LOD's triangles
+ * are in Tipsify order. Returns the LOD count, 1 if there's nothing simpler
+ * worth having (or it's out of memory) */
+uint32_t hgBuildMeshLods(HgArena *scratch,
+                         const HgVertex *verts,
+                         uint32_t vertCount,
+                         const uint32_t *inds,
+                         uint32_t indCount,
+                         uint32_t *lodInds,
+                         uint64_t lodCapacity,
+                         HgMeshLod *lods){
+  uint32_t triCount = indCount / 3;
+  lods[0].indStart = 0;
+  lods[0].indCount = indCount;
+  lods[0].error = 0.0f;
+  if(triCount < HG_LOD_MIN_TRIANGLES){
+    return 1;
+  }
+
+  HgArenaMark mark = hgArenaGetMark(scratch);
+  uint32_t *current = hgArenaPush(scratch, indCount * sizeof(uint32_t));
+  uint32_t *welded = hgArenaPush(scratch, vertCount * sizeof(uint32_t));
+  uint32_t *collapsed = hgArenaPush(scratch, vertCount * sizeof(uint32_t));
+  uint32_t *offsets = hgArenaPush(scratch, (vertCount + 1) * sizeof(uint32_t));
+  uint32_t *tris = hgArenaPush(scratch, indCount * sizeof(uint32_t));
+  uint8_t *isDead = hgArenaPush(scratch, triCount);
+  uint8_t *isMoved = hgArenaPush(scratch, vertCount);
+  uint8_t *kinds = hgArenaPush(scratch, vertCount);
+  HgLodQuadric *quadrics = hgArenaPush(scratch,
+                                       vertCount * sizeof(HgLodQuadric));
+  /* at most one per corner */
+  HgLodCollapse *collapses = hgArenaPush(scratch,
+                                         (uint64_t)indCount
+                                         * sizeof(HgLodCollapse));
+  uint32_t *order = hgArenaPush(scratch, indCount * sizeof(uint32_t));
+  HgMeshCluster *clusters = hgArenaPush(scratch,
+                                        ((uint64_t)triCount + 1)
+                                        * sizeof(HgMeshCluster));
+  if(current == NULL || welded == NULL || collapsed == NULL
+     || offsets == NULL || tris == NULL || isDead == NULL || isMoved == NULL
+     || kinds == NULL || quadrics == NULL || collapses == NULL
+     || order == NULL || clusters == NULL
+     || hgLodWeldPositions(scratch, verts, vertCount, welded)){
+    hgArenaPopToMark(scratch, mark);
+    return 1;
+  }
+
+  float diameter = 0.0f;
+  if(vertCount > 0){
+    vec3 boundsMin;
+    vec3 boundsMax;
+    hgMeshBounds(verts, vertCount, boundsMin, boundsMax);
+    for(int j = 0; j < 3; j++){
+      diameter += (boundsMax[j] - boundsMin[j]) * (boundsMax[j] - boundsMin[j]);
+    }
+    diameter = sqrtf(diameter);
+  }
+  double maxError = (double)HG_LOD_MAX_ERROR * diameter;
+  maxError *= maxError;
+
+  memcpy(current, inds, indCount * sizeof(uint32_t));
+  for(uint32_t v = 0; v < vertCount; v++){
+    collapsed[v] = v;
+  }
+  hgLodAdjacency(current, triCount, welded, vertCount, offsets, tris);
+  hgLodStartQuadrics(verts, vertCount, current, triCount,
+                     offsets, tris, welded, quadrics, kinds);
+
+  uint32_t lodCount = 1;
+  uint64_t lodUsed = 0;
+  uint32_t lastTriCount = triCount;
+  uint32_t target = (uint32_t)(triCount * HG_LOD_RATIO);
+  double error = 0.0;
+  bool isStuck = false;
+  while(lodCount < HG_MESH_MAX_LODS && !isStuck){
+    /* the cheaper way along every edge, cheapest edges first. Edges
+     * inside the mesh are listed twice, once by each triangle */
+    uint64_t collapseCount = 0;
+    for(uint32_t t = 0; t < triCount; t++){
+      const uint32_t *tri = &current[3 * (uint64_t)t];
+      for(int corner = 0; corner < 3; corner++){
+        HgLodCollapse *collapse = &collapses[collapseCount];
+        collapse->error = INFINITY;
+        for(int way = 0; way < 2; way++){
+          uint32_t from = tri[way ? (corner + 1) % 3 : corner];
+          uint32_t to = tri[way ? corner : (corner + 1) % 3];
+          bool isAlongBorder = kinds[from] == HG_LOD_BORDER
+                        && kinds[to] != HG_LOD_MANIFOLD
+                        && (hgLodIsOpenEdge(current, offsets, tris,
+                                            welded, from, to)
+                            || hgLodIsOpenEdge(current, offsets, tris,
+                                               welded, to, from));
+          bool isAllowed = from != to
+                           && (kinds[from] == HG_LOD_MANIFOLD || isAlongBorder);
+          double cost = isAllowed
+                        ? hgLodQuadricError(&quadrics[from],
+                                            verts[to].position)
+                        : INFINITY;
+          if(cost < collapse->error){
+            collapse->from = from;
+            collapse->to = to;
+            collapse->error = cost;
+          }
+        }
+        collapseCount += (collapse->error != INFINITY);
+      }
+    }
+    hgLodSortCollapses(collapses, collapseCount, order);
+
+    /* as many as can be done without one changing another's cost */
+    memset(isDead, 0, triCount);
+    memset(isMoved, 0, vertCount);
+    uint32_t liveCount = triCount;
+    uint64_t doneCount = 0;
+    for(uint64_t i = 0; i < collapseCount && liveCount > target; i++){
+      HgLodCollapse *collapse = &collapses[order[i]];
+      /* the rest of its bucket might still be under */
+      if(collapse->error > maxError){
+        isStuck = true;
+        continue;
+      }
+      if(isMoved[collapse->from] || isMoved[collapse->to]
+         || hgLodIsFlip(verts, current, offsets, tris, isDead, collapsed,
+                        collapse->from, collapse->to)){
+        continue;
+      }
+      collapsed[collapse->from] = collapse->to;
+      hgLodQuadricAdd(&quadrics[collapse->to], &quadrics[collapse->from]);
+      isMoved[collapse->from] = 1;
+      isMoved[collapse->to] = 1;
+      for(uint32_t a = offsets[collapse->from];
+          a < offsets[collapse->from + 1]; a++){
+        uint32_t t = tris[a];
+        const uint32_t *tri = &current[3 * (uint64_t)t];
+        if(!isDead[t]
+           && (hgLodFind(collapsed, tri[0]) == collapse->to)
+              + (hgLodFind(collapsed, tri[1]) == collapse->to)
+              + (hgLodFind(collapsed, tri[2]) == collapse->to) > 1){
+          isDead[t] = 1;
+          liveCount--;
+        }
+      }
+      error = MAX(error, collapse->error);
+      doneCount++;
+    }
+    isStuck = isStuck || doneCount == 0;
+
+    /* the triangles left, with their collapses */
+    uint32_t kept = 0;
+    for(uint32_t t = 0; t < triCount; t++){
+      uint32_t a = hgLodFind(collapsed, current[3 * (uint64_t)t]);
+      uint32_t b = hgLodFind(collapsed, current[3 * (uint64_t)t + 1]);
+      uint32_t c = hgLodFind(collapsed, current[3 * (uint64_t)t + 2]);
+      if(isDead[t] || a == b || b == c || c == a){
+        continue;
+      }
+      current[3 * (uint64_t)kept] = a;
+      current[3 * (uint64_t)kept + 1] = b;
+      current[3 * (uint64_t)kept + 2] = c;
+      kept++;
+    }
+    triCount = kept;
+    hgLodAdjacency(current, triCount, welded, vertCount, offsets, tris);
+
+    /* a LOD once it's at the target, or as close as it'll get */
+    bool isAtTarget = triCount <= target;
+    bool isWorthIt = triCount <= lastTriCount * HG_LOD_MIN_SAVING
+                     && triCount > 0;
+    if((isAtTarget || isStuck) && isWorthIt){
+      if(lodUsed + 3 * (uint64_t)triCount > lodCapacity){
+        break;
+      }
+      uint32_t *out = lodInds + lodUsed;
+      uint32_t clusterCount = hgMeshTipsify(scratch, current, triCount,
+                                            vertCount, out, clusters);
+      if(clusterCount == 0){
+        memcpy(out, current, 3 * (uint64_t)triCount * sizeof(uint32_t));
+      }
+      lods[lodCount].indStart = (uint32_t)(indCount + lodUsed);
+      lods[lodCount].indCount = 3 * triCount;
+      lods[lodCount].error = (diameter > 0.0f)
+                             ? (float)(sqrt(error) / diameter) : 0.0f;
+      lodUsed += 3 * (uint64_t)triCount;
+      lodCount++;
+      lastTriCount = triCount;
+      target = (uint32_t)(triCount * HG_LOD_RATIO);
+      isStuck = isStuck || triCount < HG_LOD_MIN_TRIANGLES;
+    }
+  }
+
+  hgArenaPopToMark(scratch, mark);
+  return lodCount;
+}
+
+/* Room for hgMeshLodText at every LOD */
+#define HG_LOD_TEXT_LENGTH (HG_MESH_MAX_LODS * 22)
+
+/* The triangles at each LOD in stats, i.e: "1000 500 250 125 62" */
+void hgMeshLodText(const HgMeshStats *stats, char *text, uint64_t size){
+  uint64_t used = 0;
+  text[0] = '\0';
+  for(int i = 0; i < HG_MESH_MAX_LODS; i++){
+    int written = snprintf(text + used, size - used, i ? " %llu" : "%llu",
+                           (unsigned long long)stats->lodTriCounts[i]);
+    if(written < 0 || (uint64_t)written >= size - used){
+      break;
+    }
+    used += written;
+  }
+}
@@ -0,0 +1,441 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: Reorders a mesh's triangles and vertices so the GPU does less
+ *  work drawing it, before it's uploaded or baked. Used by objLoad.c, so
+ *  meshes get it both when they're parsed at runtime and from hgbake.
+ *
+ *  Triangles are put in an order that reuses transformed vertices from the
+ *  post-transform cache (Tipsify), the runs of that order are sorted so
+ *  outward facing ones draw first (less overdraw), then vertices are
+ *  renumbered in the order they're first used (better vertex fetch).
+ *  See Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex
+ *  Locality and Reduced Overdraw", 2007.
+ *
+ *  Also packs vertices into HgCompactVertex, for meshes that want half the
+ *  vertex memory.
+ */
+
+/* Vertices the post-transform cache is modeled to hold, when ordering
+ * triangles and when counting misses */
+#define HG_MESH_CACHE_SIZE 16
+
+/* Cache misses before and after hgOptimizeMesh, for every mesh it was run
+ * on. ACMR is misses per triangle (0.5 at best, 3 at worst), ATVR is
+ * misses per vertex (1 at best) */
+typedef struct HgMeshStats {
+  uint64_t triCount;
+  uint64_t vertCount;
+  uint64_t missesBefore;
+  uint64_t missesAfter;
+  uint64_t lodTriCounts[HG_MESH_MAX_LODS]; /* triangles at each LOD, or
+                                              the simplest one there is */
+}HgMeshStats;
+
+/* Adds other's counts to stats */
+void hgAddMeshStats(HgMeshStats *stats, const HgMeshStats *other){
+  stats->triCount += other->triCount;
+  stats->vertCount += other->vertCount;
+  stats->missesBefore += other->missesBefore;
+  stats->missesAfter += other->missesAfter;
+  for(int i = 0; i < HG_MESH_MAX_LODS; i++){
+    stats->lodTriCounts[i] += other->lodTriCounts[i];
+  }
+}
+
+double hgMeshAcmr(const HgMeshStats *stats, uint64_t misses){
+  return stats->triCount ? (double)misses / stats->triCount : 0.0;
+}
+
+double hgMeshAtvr(const HgMeshStats *stats, uint64_t misses){
+  return stats->vertCount ? (double)misses / stats->vertCount : 0.0;
+}
+
+/* A run of triangles from hgMeshTipsify, the cache is cold at its start */
+typedef struct HgMeshCluster {
+  uint32_t start;  /* first index */
+  uint32_t count;  /* indices */
+  float centre[3]; /* area weighted */
+  float normal[3]; /* area weighted, not normalized */
+  float area;
+  float sortKey;
+}HgMeshCluster;
+
+/* Vertex shader runs drawing inds, with a FIFO cache of HG_MESH_CACHE_SIZE
+ * vertices. Returns UINT64_MAX if out of memory */
+uint64_t hgMeshCacheMisses(HgArena *scratch,
+                           const uint32_t *inds,
+                           uint64_t indCount,
+                           uint32_t vertCount){
+  HgArenaMark mark = hgArenaGetMark(scratch);
+  /* when each vertex went in the cache, in misses so far */
+  uint64_t *cacheTime = hgArenaPushZero(scratch, vertCount * sizeof(uint64_t));
+  if(cacheTime == NULL){
+    return UINT64_MAX;
+  }
+  uint64_t time = HG_MESH_CACHE_SIZE;
+  for(uint64_t i = 0; i < indCount; i++){
+    if(time - cacheTime[inds[i]] >= HG_MESH_CACHE_SIZE){
+      cacheTime[inds[i]] = time++;
+    }
+  }
+  hgArenaPopToMark(scratch, mark);
+  return time - HG_MESH_CACHE_SIZE;
+}
+
+/* Tipsify's next vertex to fan around: the candidate (a vertex of the last
+ * fan) that will still be in the cache after its own fan, the oldest of
+ * those first. Otherwise a vertex from a dead end, or the next vertex with
+ * triangles left. Returns UINT32_MAX when every triangle is out */
+uint32_t hgMeshNextFan(const uint32_t *candidates,
+                       uint32_t candidateCount,
+                       const uint32_t *deadEnds,
+                       uint32_t *deadEndCount,
+                       const uint32_t *live,
+                       const uint64_t *cacheTime,
+                       uint64_t time,
+                       uint32_t *cursor,
+                       uint32_t vertCount){
+  uint32_t best = UINT32_MAX;
+  int64_t bestPriority = -1;
+  for(uint32_t i = 0; i < candidateCount; i++){
+    uint32_t v = candidates[i];
+    if(live[v] == 0){
+      continue;
+    }
+    int64_t priority = 0;
+    if(time - cacheTime[v] + 2 * live[v] <= HG_MESH_CACHE_SIZE){
+      priority = (int64_t)(time - cacheTime[v]);
+    }
+    if(priority > bestPriority){
+      best = v;
+      bestPriority = priority;
+    }
+  }
+  if(best != UINT32_MAX){
+    return best;
+  }
+
+  while(*deadEndCount > 0){
+    uint32_t v = deadEnds[--(*deadEndCount)];
+    if(live[v] > 0){
+      return v;
+    }
+  }
+  for(; *cursor < vertCount; (*cursor)++){
+    if(live[*cursor] > 0){
+      return *cursor;
+    }
+  }
+  return UINT32_MAX;
+}
+
+/* Triangles in Tipsify order into out, split into clusters wherever the
+ * cache goes cold. clusters needs room for triCount + 1 (the first can be
+ * empty). Returns the cluster count, 0 if out of memory */
+uint32_t hgMeshTipsify(HgArena *scratch,
+                       const uint32_t *inds,
+                       uint32_t triCount,
+                       uint32_t vertCount,
+                       uint32_t *out,
+                       HgMeshCluster *clusters){
+  HgArenaMark mark = hgArenaGetMark(scratch);
+  uint32_t *live = hgArenaPushZero(scratch, vertCount * sizeof(uint32_t));
+  uint32_t *offsets = hgArenaPushZero(scratch,
+                                      (vertCount + 1) * sizeof(uint32_t));
+  uint32_t *adjacent = hgArenaPush(scratch, 3 * triCount * sizeof(uint32_t));
+  uint64_t *cacheTime = hgArenaPushZero(scratch, vertCount * sizeof(uint64_t));
+  uint8_t *isEmitted = hgArenaPushZero(scratch, triCount);
+  uint32_t *deadEnds = hgArenaPush(scratch, 3 * triCount * sizeof(uint32_t));
+  if(live == NULL || offsets == NULL || adjacent == NULL
+     || cacheTime == NULL || isEmitted == NULL || deadEnds == NULL){
+    hgArenaPopToMark(scratch, mark);
+    return 0;
+  }
+
+  /* the triangles around each vertex */
+  for(uint64_t i = 0; i < 3 * (uint64_t)triCount; i++){
+    live[inds[i]]++;
+  }
+  for(uint32_t v = 0; v < vertCount; v++){
+    offsets[v + 1] = offsets[v] + live[v];
+  }
+  for(uint64_t i = 0; i < 3 * (uint64_t)triCount; i++){
+    adjacent[offsets[inds[i]]++] = (uint32_t)(i / 3);
+  }
+  for(uint32_t v = vertCount; v > 0; v--){
+    offsets[v] = offsets[v - 1];
+  }
+  offsets[0] = 0;
+
+  uint64_t time = HG_MESH_CACHE_SIZE + 1;
+  uint32_t deadEndCount = 0;
+  uint32_t cursor = 0;
+  uint32_t outCount = 0;
+  uint32_t clusterCount = 0;
+  uint32_t fan = 0;
+  while(fan != UINT32_MAX){
+    if(time - cacheTime[fan] > HG_MESH_CACHE_SIZE){
+      if(clusterCount > 0){
+        clusters[clusterCount - 1].count = outCount
+                                           - clusters[clusterCount - 1].start;
+      }
+      clusters[clusterCount].start = outCount;
+      clusterCount++;
+    }
+
+    /* the fan's vertices are pushed as dead ends, and are the candidates */
+    uint32_t fanStart = deadEndCount;
+    for(uint32_t a = offsets[fan]; a < offsets[fan + 1]; a++){
+      uint32_t tri = adjacent[a];
+      if(isEmitted[tri]){
+        continue;
+      }
+      isEmitted[tri] = 1;
+      for(int corner = 0; corner < 3; corner++){
+        uint32_t v = inds[3 * (uint64_t)tri + corner];
+        out[outCount++] = v;
+        deadEnds[deadEndCount++] = v;
+        live[v]--;
+        if(time - cacheTime[v] > HG_MESH_CACHE_SIZE){
+          cacheTime[v] = time++;
+        }
+      }
+    }
+
+    fan = hgMeshNextFan(deadEnds + fanStart,
+                        deadEndCount - fanStart,
+                        deadEnds,
+                        &deadEndCount,
+                        live,
+                        cacheTime,
+                        time,
+                        &cursor,
+                        vertCount);
+  }
+  clusters[clusterCount - 1].count = outCount - clusters[clusterCount - 1].start;
+
+  hgArenaPopToMark(scratch, mark);
+  return clusterCount;
+}
+
+int hgMeshCompareClusters(const void *a, const void *b){
+  float keyA = ((const HgMeshCluster*)a)->sortKey;
+  float keyB = ((const HgMeshCluster*)b)->sortKey;
+  return (keyA < keyB) - (keyA > keyB);
+}
+
+/* Outward facing clusters first, so they hide what's drawn after them.
+ * The key is how far in front of the mesh's centre the cluster is, along
+ * the cluster's average normal */
+void hgMeshSortClusters(const HgVertex *verts,
+                        const uint32_t *inds,
+                        HgMeshCluster *clusters,
+                        uint32_t clusterCount){
+  float meshCentre[3] = {0.0f, 0.0f, 0.0f};
+  float meshArea = 0.0f;
+  for(uint32_t c = 0; c < clusterCount; c++){
+    HgMeshCluster *cluster = &clusters[c];
+    memset(cluster->centre, 0, sizeof(cluster->centre));
+    memset(cluster->normal, 0, sizeof(cluster->normal));
+    cluster->area = 0.0f;
+    for(uint32_t i = cluster->start; i < cluster->start + cluster->count; i += 3){
+      const float *p0 = verts[inds[i]].position;
+      const float *p1 = verts[inds[i + 1]].position;
+      const float *p2 = verts[inds[i + 2]].position;
+      float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+      /* twice the triangle's area long */
+      float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                    e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0]};
+      float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      for(int j = 0; j < 3; j++){
+        cluster->centre[j] += (p0[j] + p1[j] + p2[j]) / 3.0f * area;
+        cluster->normal[j] += n[j];
+      }
+      cluster->area += area;
+    }
+    for(int j = 0; j < 3; j++){
+      meshCentre[j] += cluster->centre[j];
+    }
+    meshArea += cluster->area;
+  }
+
+  for(int j = 0; j < 3; j++){
+    meshCentre[j] = (meshArea > 0.0f) ? meshCentre[j] / meshArea : 0.0f;
+  }
+  for(uint32_t c = 0; c < clusterCount; c++){
+    HgMeshCluster *cluster = &clusters[c];
+    float length = sqrtf(cluster->normal[0] * cluster->normal[0]
+                         + cluster->normal[1] * cluster->normal[1]
+                         + cluster->normal[2] * cluster->normal[2]);
+    cluster->sortKey = 0.0f;
+    if(length > 0.0f && cluster->area > 0.0f){
+      for(int j = 0; j < 3; j++){
+        float offset = cluster->centre[j] / cluster->area - meshCentre[j];
+        cluster->sortKey += offset * cluster->normal[j] / length;
+      }
+    }
+  }
+  qsort(clusters, clusterCount, sizeof(HgMeshCluster), hgMeshCompareClusters);
+}
+
+/* Reorders inds for the post-transform cache and overdraw, then verts (and
+ * inds to match) in the order they're first used. Adds the cache misses
+ * before and after to stats. Leaves the mesh as it was if out of memory */
+void hgOptimizeMesh(HgArena *scratch,
+                    HgVertex *verts,
+                    uint32_t vertCount,
+                    uint32_t *inds,
+                    uint64_t indCount,
+                    HgMeshStats *stats){
+  if(indCount < 3 || indCount % 3 != 0 || indCount / 3 > UINT32_MAX){
+    return;
+  }
+  uint32_t triCount = (uint32_t)(indCount / 3);
+
+  HgArenaMark mark = hgArenaGetMark(scratch);
+  uint32_t *ordered = hgArenaPush(scratch, indCount * sizeof(uint32_t));
+  HgMeshCluster *clusters = hgArenaPush(scratch,
+                                        ((uint64_t)triCount + 1)
+                                        * sizeof(HgMeshCluster));
+  uint32_t *remap = hgArenaPush(scratch, vertCount * sizeof(uint32_t));
+  HgVertex *fetched = hgArenaPush(scratch, vertCount * sizeof(HgVertex));
+  uint64_t missesBefore = hgMeshCacheMisses(scratch, inds, indCount, vertCount);
+  uint32_t clusterCount = 0;
+  if(ordered != NULL && clusters != NULL && remap != NULL && fetched != NULL
+     && missesBefore != UINT64_MAX){
+    clusterCount = hgMeshTipsify(scratch, inds, triCount, vertCount,
+                                 ordered, clusters);
+  }
+  if(clusterCount == 0){
+    hgArenaPopToMark(scratch, mark);
+    return;
+  }
+
+  hgMeshSortClusters(verts, ordered, clusters, clusterCount);
+  uint64_t at = 0;
+  for(uint32_t c = 0; c < clusterCount; c++){
+    memcpy(inds + at,
+           ordered + clusters[c].start,
+           clusters[c].count * sizeof(uint32_t));
+    at += clusters[c].count;
+  }
+
+  /* vertex fetch order, unused vertices go at the end */
+  memset(remap, 0xff, vertCount * sizeof(uint32_t));
+  uint32_t next = 0;
+  for(uint64_t i = 0; i < indCount; i++){
+    if(remap[inds[i]] == UINT32_MAX){
+      remap[inds[i]] = next++;
+    }
+    inds[i] = remap[inds[i]];
+  }
+  for(uint32_t v = 0; v < vertCount; v++){
+    if(remap[v] == UINT32_MAX){
+      remap[v] = next++;
+    }
+    fetched[remap[v]] = verts[v];
+  }
+  memcpy(verts, fetched, vertCount * sizeof(HgVertex));
+
+  stats->triCount += triCount;
+  stats->vertCount += vertCount;
+  stats->missesBefore += missesBefore;
+  stats->missesAfter += hgMeshCacheMisses(scratch, inds, indCount, vertCount);
+  hgArenaPopToMark(scratch, mark);
+}
+
+/* Smallest box around every vertex, all 0 with no vertices */
+void hgMeshBounds(const HgVertex *verts,
+                  uint32_t vertCount,
+                  vec3 boundsMin,
+                  vec3 boundsMax){
+  for(int j = 0; j < 3; j++){
+    boundsMin[j] = vertCount ? verts[0].position[j] : 0.0f;
+    boundsMax[j] = boundsMin[j];
+  }
+  for(uint32_t i = 1; i < vertCount; i++){
+    for(int j = 0; j < 3; j++){
+      boundsMin[j] = MIN(boundsMin[j], verts[i].position[j]);
+      boundsMax[j] = MAX(boundsMax[j], verts[i].position[j]);
+    }
+  }
+}
+
+/* Nearest half float, too big is infinity */
+uint16_t hgFloatToHalf(float value){
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t magnitude = bits & 0x7fffffff;
+  if(magnitude > 0x7f800000){
+    return sign | 0x7e00; /* NaN */
+  }
+  if(magnitude >= 0x477ff000){
+    return sign | 0x7c00; /* rounds past 65504 */
+  }
+  if(magnitude < 0x33000000){
+    return sign; /* rounds to 0 */
+  }
+  if(magnitude < 0x38800000){
+    /* subnormal, in steps of 2^-24, rounded to nearest even */
+    uint32_t shift = 126 - (magnitude >> 23);
+    uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+    uint32_t half = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t tie = 1u << (shift - 1);
+    half += (rest > tie || (rest == tie && (half & 1)));
+    return sign | (uint16_t)half;
+  }
+  /* rebias the exponent, round the 13 dropped bits to nearest even */
+  magnitude += 0xc8000fff + ((magnitude >> 13) & 1);
+  return sign | (uint16_t)(magnitude >> 13);
+}
+
+/* 0-1 as 0-65535 */
+uint16_t hgMeshUnorm16(float value){
+  value = MIN(MAX(value, 0.0f), 1.0f);
+  return (uint16_t)(value * 65535.0f + 0.5f);
+}
+
+/* -1-1 as -127-127 */
+int8_t hgMeshSnorm8(float value){
+  value = MIN(MAX(value, -1.0f), 1.0f);
+  return (int8_t)(value * 127.0f + ((value < 0.0f) ? -0.5f : 0.5f));
+}
+
+/* verts as HG_VERTEX_COMPACT. Positions are stored across the bounds
+ * (from hgMeshBounds), so each axis gets all 16 bits however big the mesh
+ * is. Normals are normalized first, the shader gets them back within 1% */
+void hgCompactVertices(const HgVertex *verts,
+                       uint32_t vertCount,
+                       const vec3 boundsMin,
+                       const vec3 boundsMax,
+                       HgCompactVertex *compact){
+  float toUnit[3];
+  for(int j = 0; j < 3; j++){
+    float extent = boundsMax[j] - boundsMin[j];
+    toUnit[j] = (extent > 0.0f) ? 1.0f / extent : 0.0f;
+  }
+  for(uint32_t i = 0; i < vertCount; i++){
+    const HgVertex *vert = &verts[i];
+    HgCompactVertex *out = &compact[i];
+    float length = sqrtf(vert->normal[0] * vert->normal[0]
+                         + vert->normal[1] * vert->normal[1]
+                         + vert->normal[2] * vert->normal[2]);
+    float toNormal = (length > 0.0f) ? 1.0f / length : 0.0f;
+    for(int j = 0; j < 3; j++){
+      out->position[j] = hgMeshUnorm16((vert->position[j] - boundsMin[j])
+                                       * toUnit[j]);
+      out->normal[j] = hgMeshSnorm8(vert->normal[j] * toNormal);
+    }
+    out->position[3] = 0;
+    out->normal[3] = 0;
+    out->texture[0] = hgFloatToHalf(vert->texture[0]);
+    out->texture[1] = hgFloatToHalf(vert->texture[1]);
+  }
+}
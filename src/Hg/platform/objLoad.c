@@ -7,229 +7,1273 @@
  *  associated mtl file, to generate a mesh.
  */
 
-typedef struct HgObjFileCounts {
-  uint16_t verts;
-  uint16_t pos;
-  uint16_t texs;
-  uint16_t norms;
-  uint32_t inds;
-}HgObjFileCounts;
-
-void hgGetMtlTexture(HgArena *arena,
-                     HgMesh *mesh,
-                     char* mtlFile,
-                     char* useMtl){
-
-  size_t mtlSize = hgGetFileSize(mtlFile);
-  char* mtlBuffer = hgArenaPush(arena, mtlSize);
-  hgGetFileStr(mtlBuffer, mtlSize, mtlFile);
-
-  bool isMtlFound = false;
-  char* word = strtok(mtlBuffer, "\n ");
-  while(word){
-
-    if(strcmp(word, "newmtl") == 0){
-      word = strtok(NULL, "\n ");
-      if(strcmp(word, useMtl) == 0){
-        isMtlFound = true;
-        word = strtok(NULL, "\n ");
-      }
+#include "hgmesh.h"
+
+/* Address space reserved for each array while parsing, only what's used
+ * is committed. The per vertex arrays reserve the obj's size times
+ * HG_OBJ_SCRATCH_SCALE, and chain on more blocks if that's not enough */
+#define HG_OBJ_SCRATCH_MIN MEGABYTES(1)
+#define HG_OBJ_SCRATCH_SCALE 2
+
+/* Elements in an array's first push, it doubles after that */
+#define HG_OBJ_ARRAY_START 4096
+
+/* Slots in the corner table at first, it doubles when half full */
+#define HG_OBJ_CORNERS_START 8192
+
+/* Marks an empty corner table slot, or a corner without a vt or vn */
+#define HG_OBJ_NONE UINT32_MAX
+
+/* Layout objs are made and baked in, unless a stale bake was made in
+ * another one (i.e: with hgbake -c) */
+#ifndef HG_OBJ_LAYOUT
+#define HG_OBJ_LAYOUT HG_VERTEX_FLOAT
+#endif
+
+/* A word inside a mapped file, NOT null terminated */
+typedef struct HgObjWord {
+  const char *str;
+  size_t len;
+}HgObjWord;
+
+bool hgObjWordIs(HgObjWord word, const char *str){
+  return word.len == strlen(str) && memcmp(word.str, str, word.len) == 0;
+}
+
+/* An array that grows on its own scratch arena. Nothing else is pushed
+ * there, so growing is just pushing more on the end */
+typedef struct HgObjArray {
+  HgArena *arena;
+  uint8_t *data;
+  uint64_t count;
+  uint64_t capacity;
+  uint64_t stride;
+}HgObjArray;
+
+int hgObjArrayInit(HgObjArray *array, uint64_t stride, uint64_t reserve){
+  array->arena = hgCreateArenaEx(reserve,
+                                 4,
+                                 HGL_ARENA_VIRTUAL | HGL_ARENA_GROWABLE);
+  array->data = NULL;
+  array->count = 0;
+  array->capacity = 0;
+  array->stride = stride;
+  return (array->arena == NULL) ? -1 : 0;
+}
+
+void hgObjArrayDestroy(HgObjArray *array){
+  if(array->arena != NULL){
+    hgDestroyArena(array->arena);
+    array->arena = NULL;
+  }
+}
+
+/* Room for one more element at the end, NULL if out of memory */
+void* hgObjArrayAdd(HgObjArray *array){
+  if(array->count == array->capacity){
+    uint64_t more = array->capacity ? array->capacity : HG_OBJ_ARRAY_START;
+    uint8_t *pushed = hgArenaPush(array->arena, more * array->stride);
+    if(pushed == NULL){
+      return NULL;
     }
-   
-    if(isMtlFound){
-      if(strcmp(word, "map_Kd") == 0){
-        word = strtok(NULL, "\n ");
-        hgLoadMeshTexture(mesh, word);
-        break;
+    if(array->data == NULL){
+      array->data = pushed;
+    }else if(pushed != array->data + array->capacity * array->stride){
+      /* the arena moved on to a new block, so move the array there */
+      uint8_t *moved = hgArenaPush(array->arena,
+                                   (array->capacity + more) * array->stride);
+      if(moved == NULL){
+        return NULL;
       }
+      memcpy(moved, array->data, array->count * array->stride);
+      array->data = moved;
     }
-    word = strtok(NULL, "\n ");
+    array->capacity += more;
   }
-  
-  hgArenaPop(arena, mtlBuffer, mtlSize);  
+  return array->data + array->stride * array->count++;
 }
 
-void hgObjGetCount(HgArena *arena,
-                   const char* file,
-                   HgObjFileCounts *counts){
-  counts->verts = 0;
-  counts->pos = 0;
-  counts->texs = 0;
-  counts->norms = 0;
-  counts->inds = 0;
+/* A face corner's v/vt/vn indices, and the vertex made for them */
+typedef struct HgObjCorner {
+  uint32_t pos;
+  uint32_t tex;
+  uint32_t norm;
+  uint32_t vert;
+}HgObjCorner;
 
-  char objFile[PATH_LENGTH];
-  snprintf(objFile, PATH_LENGTH, "res/models/%s.obj", file);
-  size_t objSize = hgGetFileSize(objFile);
-  char* objBuffer = hgArenaPush(arena, objSize);
-  hgGetFileStr(objBuffer, objSize, objFile);
-  
-  char* line = strtok(objBuffer, "\n");
-  while(line){
-    if(strncmp(line, "v ", 2) == 0){
-      counts->pos++;
+/* Open addressing table of every distinct corner so far, so corners that
+ * share v/vt/vn share a vertex. Old tables are left on the scratch arena
+ * when it grows, that's never more than the final table again */
+typedef struct HgObjCorners {
+  HgArena *arena;
+  HgObjCorner *slots;
+  uint64_t capacity;  /* power of 2 */
+  uint64_t count;
+}HgObjCorners;
+
+uint64_t hgObjCornerHash(uint32_t pos, uint32_t tex, uint32_t norm){
+  uint64_t hash = pos * 0x9e3779b97f4a7c15ull
+                  ^ tex * 0xc2b2ae3d27d4eb4full
+                  ^ norm * 0x165667b19e3779f9ull;
+  return hash ^ (hash >> 32);
+}
+
+int hgObjCornersResize(HgObjCorners *corners, uint64_t capacity){
+  HgObjCorner *slots = hgArenaPush(corners->arena,
+                                   capacity * sizeof(HgObjCorner));
+  if(slots == NULL){
+    return -1;
+  }
+  memset(slots, 0xff, capacity * sizeof(HgObjCorner));
+  for(uint64_t i = 0; i < corners->capacity; i++){
+    HgObjCorner *corner = &corners->slots[i];
+    if(corner->vert == HG_OBJ_NONE){
+      continue;
     }
-    if(strncmp(line, "vt ", 3) == 0){
-      counts->texs++;
+    uint64_t slot = hgObjCornerHash(corner->pos, corner->tex, corner->norm)
+                    & (capacity - 1);
+    while(slots[slot].vert != HG_OBJ_NONE){
+      slot = (slot + 1) & (capacity - 1);
+    }
+    slots[slot] = *corner;
+  }
+  corners->slots = slots;
+  corners->capacity = capacity;
+  return 0;
+}
+
+int hgObjCornersInit(HgObjCorners *corners, uint64_t reserve){
+  corners->arena = hgCreateArenaEx(reserve,
+                                   4,
+                                   HGL_ARENA_VIRTUAL | HGL_ARENA_GROWABLE);
+  corners->slots = NULL;
+  corners->capacity = 0;
+  corners->count = 0;
+  if(corners->arena == NULL){
+    return -1;
+  }
+  return hgObjCornersResize(corners, HG_OBJ_CORNERS_START);
+}
+
+/* Empties the table, back to its starting size */
+int hgObjCornersClear(HgObjCorners *corners){
+  hgArenaPopAll(corners->arena);
+  corners->slots = NULL;
+  corners->capacity = 0;
+  corners->count = 0;
+  return hgObjCornersResize(corners, HG_OBJ_CORNERS_START);
+}
+
+void hgObjCornersDestroy(HgObjCorners *corners){
+  if(corners->arena != NULL){
+    hgDestroyArena(corners->arena);
+    corners->arena = NULL;
+  }
+}
+
+/* The slot for this corner, either holding it already or empty (vert is
+ * HG_OBJ_NONE) for it to be added. NULL if out of memory */
+HgObjCorner* hgObjCornersFind(HgObjCorners *corners,
+                              uint32_t pos,
+                              uint32_t tex,
+                              uint32_t norm){
+  if(corners->count * 2 >= corners->capacity
+     && hgObjCornersResize(corners, corners->capacity * 2)){
+    return NULL;
+  }
+  uint64_t slot = hgObjCornerHash(pos, tex, norm) & (corners->capacity - 1);
+  while(corners->slots[slot].vert != HG_OBJ_NONE){
+    HgObjCorner *corner = &corners->slots[slot];
+    if(corner->pos == pos && corner->tex == tex && corner->norm == norm){
+      return corner;
     }
-    if(strncmp(line, "vn ", 3) == 0){
-      counts->norms++;
+    slot = (slot + 1) & (corners->capacity - 1);
+  }
+  return &corners->slots[slot];
+}
+
+/* Names are kept in HgObjParser.names, by offset since it can move */
+typedef struct HgObjName {
+  uint64_t offset;
+  uint64_t len;
+}HgObjName;
+
+/* An 'o' object, and the mesh made from its faces */
+typedef struct HgObjObject {
+  HgObjName name;
+  HgObjName material;  /* from usemtl */
+  HgObjName texture;   /* map_Kd of the material */
+  HgMesh *mesh;        /* NULL if it was only parsed to be baked */
+}HgObjObject;
+
+/* A newmtl from the mtl file */
+typedef struct HgObjMaterial {
+  HgObjName name;
+  HgObjName texture;   /* from map_Kd */
+}HgObjMaterial;
+
+/* Everything one parse needs, so files can be parsed on several threads */
+typedef struct HgObjParser {
+  const char *at;    /* start of the next line */
+  const char *end;
+  HgArena *fileArena; /* the mapped file, if it had to be decoded */
+  HgObjArray pos;    /* vec3, every v in the file so far */
+  HgObjArray tex;    /* vec2 */
+  HgObjArray norm;   /* vec3 */
+  HgObjArray verts;  /* HgVertex, one per distinct corner of this object */
+  HgObjArray inds;   /* uint32_t, narrowed when the object is done */
+  HgObjCorners corners;
+  HgObjArray names;  /* char, every name null terminated */
+  HgObjArray objects;   /* HgObjObject */
+  HgObjArray materials; /* HgObjMaterial */
+  uint32_t layout;      /* HG_VERTEX_FLOAT or HG_VERTEX_COMPACT */
+  FILE *bake;           /* .hgmesh being written, NULL if not baking */
+  bool isBakeOnly;      /* no meshes, only the bake (for hgbake) */
+  HgMeshStats stats;    /* from hgOptimizeMesh, for every object */
+  uint64_t bakeSize;    /* bytes written to it so far */
+  HgMeshHeader bakeHeader;
+  HgObjArray entries;   /* HgMeshEntry, one per object when baking */
+  bool isError;
+}HgObjParser;
+
+bool hgObjIsSpace(char c){
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* hgObjSkipSpace(const char *at, const char *end){
+  while(at < end && hgObjIsSpace(*at)){
+    at++;
+  }
+  return at;
+}
+
+/* Does the line start with this keyword, followed by a space? */
+bool hgObjIsKeyword(const char *at, const char *end, const char *keyword){
+  size_t len = strlen(keyword);
+  return (size_t)(end - at) > len
+         && memcmp(at, keyword, len) == 0
+         && hgObjIsSpace(at[len]);
+}
+
+/* The rest of the line as a word, without the spaces around it */
+HgObjWord hgObjLineRest(const char *at, const char *end){
+  at = hgObjSkipSpace(at, end);
+  while(end > at && hgObjIsSpace(end[-1])){
+    end--;
+  }
+  HgObjWord word = {at, (size_t)(end - at)};
+  return word;
+}
+
+/* Missing numbers are 0 (i.e: "vt 0.5" has no v), anything else that
+ * isn't a number is an error */
+int hgObjParseFloat(const char **at, const char *end, float *out){
+  const char *p = hgObjSkipSpace(*at, end);
+  *out = 0.0f;
+  if(p == end){
+    *at = p;
+    return 0;
+  }
+  p = hgParseFloat(p, end, out);
+  if(p == NULL || (p < end && !hgObjIsSpace(*p))){
+    return -1;
+  }
+  *at = p;
+  return 0;
+}
+
+/* OBJ indices start at 1, and negative ones count back from the end.
+ * A bad index comes back as INT64_MAX, which is always out of range */
+int64_t hgObjParseIndex(const char **at, const char *end, uint64_t count){
+  int64_t value;
+  const char *p = hgParseInt(*at, end, &value);
+  if(p == NULL || value == 0){
+    return INT64_MAX;
+  }
+  *at = p;
+  return (value < 0) ? (int64_t)count + value : value - 1;
+}
+
+/* One face corner (p, p/t, p//n or p/t/n) to an index, and a new vertex
+ * the first time those v/vt/vn are used together */
+int hgObjAddCorner(HgObjParser *parser, const char **at, const char *end){
+  const char *p = *at;
+  int64_t posInd = hgObjParseIndex(&p, end, parser->pos.count);
+  int64_t texInd = 0;
+  int64_t normInd = 0;
+  bool isTex = false;
+  bool isNorm = false;
+  if(p < end && *p == '/'){
+    p++;
+    if(p < end && *p != '/'){
+      texInd = hgObjParseIndex(&p, end, parser->tex.count);
+      isTex = true;
     }
-    if(strncmp(line, "f ", 2) == 0){
-      counts->inds += 3;
+    if(p < end && *p == '/'){
+      p++;
+      normInd = hgObjParseIndex(&p, end, parser->norm.count);
+      isNorm = true;
     }
+  }
+  *at = p;
+
+  /* a negative index from before the first one is as bad as past the end */
+  if(posInd < 0 || (uint64_t)posInd >= parser->pos.count
+     || (isTex && (texInd < 0 || (uint64_t)texInd >= parser->tex.count))
+     || (isNorm && (normInd < 0
+                    || (uint64_t)normInd >= parser->norm.count))){
+    return -1;
+  }
+
+  HgObjCorner *corner = hgObjCornersFind(&parser->corners,
+      (uint32_t)posInd,
+      isTex ? (uint32_t)texInd : HG_OBJ_NONE,
+      isNorm ? (uint32_t)normInd : HG_OBJ_NONE);
+  uint32_t *ind = hgObjArrayAdd(&parser->inds);
+  if(corner == NULL || ind == NULL){
+    return -1;
+  }
+  if(corner->vert != HG_OBJ_NONE){
+    *ind = corner->vert;
+    return 0;
+  }
 
-    line = strtok(NULL, "\n");
-  }//line
+  HgVertex *vert = hgObjArrayAdd(&parser->verts);
+  if(vert == NULL){
+    return -1;
+  }
+  memset(vert, 0, sizeof(HgVertex));
+  memcpy(vert->position,
+         parser->pos.data + posInd * sizeof(vec3),
+         sizeof(vec3));
+  if(isTex){
+    memcpy(vert->texture,
+           parser->tex.data + texInd * sizeof(vec2),
+           sizeof(vec2));
+  }
+  if(isNorm){
+    memcpy(vert->normal,
+           parser->norm.data + normInd * sizeof(vec3),
+           sizeof(vec3));
+  }
+  corner->pos = (uint32_t)posInd;
+  corner->tex = isTex ? (uint32_t)texInd : HG_OBJ_NONE;
+  corner->norm = isNorm ? (uint32_t)normInd : HG_OBJ_NONE;
+  corner->vert = (uint32_t)(parser->verts.count - 1);
+  parser->corners.count++;
+  *ind = corner->vert;
+  return 0;
+}
 
-  counts->verts = counts->inds;
+/* Faces with more than 3 corners are split into a fan of triangles */
+int hgObjAddFace(HgObjParser *parser, const char *at, const char *end){
+  const char *corners[3];
+  int cornerCount = 0;
 
-  if(counts->verts > 65535){
-    HG_WARN("Model %s has too many verts for uint16_t", objFile);
+  at = hgObjSkipSpace(at, end);
+  while(at < end){
+    const char *corner = at;
+    while(at < end && !hgObjIsSpace(*at)){
+      at++;
+    }
+    if(cornerCount < 3){
+      corners[cornerCount++] = corner;
+    }else{
+      corners[1] = corners[2];
+      corners[2] = corner;
+    }
+    if(cornerCount == 3){
+      for(int i = 0; i < 3; i++){
+        const char *c = corners[i];
+        if(hgObjAddCorner(parser, &c, end)){
+          return -1;
+        }
+      }
+    }
+    at = hgObjSkipSpace(at, end);
   }
-  hgArenaPop(arena, objBuffer, objSize);
+  return (cornerCount == 3) ? 0 : -1;
 }
 
-HgMesh* hgLoadObjMesh(HgArena *arena,
-                      const char* file,
-                      const char* object){
+/* Rewrites the indices as uint16_t in place, if the verts fit. Returns
+ * the bytes per index left in the buffer */
+uint32_t hgObjNarrowIndices(uint32_t *inds, uint64_t indCount, uint64_t vertCount){
+  uint32_t indSize = hgIndexSize(vertCount);
+  if(indSize == sizeof(uint16_t)){
+    /* each write lands at or before the read, so nothing is overwritten
+     * before it's read */
+    uint16_t *narrow = (uint16_t*)inds;
+    for(uint64_t i = 0; i < indCount; i++){
+      narrow[i] = (uint16_t)inds[i];
+    }
+  }
+  return indSize;
+}
 
-  HgMesh *mesh = hgArenaPush(arena, sizeof(HgMesh));
+HgObjName hgObjAddName(HgObjParser *parser, HgObjWord word){
+  HgObjName name = {parser->names.count, word.len};
+  for(size_t i = 0; i <= word.len; i++){
+    char *c = hgObjArrayAdd(&parser->names);
+    if(c == NULL){
+      parser->isError = true;
+      break;
+    }
+    *c = (i < word.len) ? word.str[i] : '\0';
+  }
+  return name;
+}
 
-  HgObjFileCounts counts = {0};
-  hgObjGetCount(arena, file, &counts);
-  
-  uint16_t vertIndex = 0;
-  uint16_t posIndex = 0;
-  uint16_t texIndex = 0;
-  uint16_t normIndex = 0;
-  uint32_t indsIndex = 0;
+const char* hgObjGetName(HgObjParser *parser, HgObjName name){
+  return (const char*)parser->names.data + name.offset;
+}
 
-  vec3 *v = hgArenaPush(arena, counts.verts * sizeof(vec3));
-  vec2 *vt = hgArenaPush(arena, counts.texs * sizeof(vec2));
-  vec3 *vn = hgArenaPush(arena, counts.norms * sizeof(vec3));
-  HgVertex *verts = hgArenaPush(arena, counts.verts * sizeof(HgVertex));
-  uint16_t *inds = hgArenaPush(arena, counts.inds * sizeof(uint16_t));
+bool hgObjNameIs(HgObjParser *parser, HgObjName a, HgObjName b){
+  return a.len == b.len
+         && memcmp(hgObjGetName(parser, a), hgObjGetName(parser, b), a.len) == 0;
+}
 
-  char objFile[PATH_LENGTH] = {0};
-  char mtlFile[PATH_LENGTH] = {0};
-  char usedMtl[PATH_LENGTH] = {0};
+/* Every material in the mtl file, read once for all the objects */
+void hgObjLoadMaterials(HgObjParser *parser, const char *mtlFile){
+  HgFileMap mtlMap = hgMapFileEx(parser->fileArena, mtlFile);
+  const char *at = mtlMap.data;
+  const char *end = mtlMap.data + mtlMap.size;
+  if(parser->bake != NULL && mtlMap.data != NULL){
+    hgStampBakeSource(&parser->bakeHeader.mtl, mtlFile, &mtlMap);
+  }
 
-  snprintf(objFile, PATH_LENGTH, "res/models/%s.obj", file);
-  size_t objSize = hgGetFileSize(objFile);
-  char* objBuffer = hgArenaPush(arena, objSize);
-  hgGetFileStr(objBuffer, objSize, objFile);
-
-  bool objFound = false;
-  char* word = strtok(objBuffer, "\n /");
-  while(word != NULL){
-    if(objFound){
-      // object
-      if(strcmp(word, "o") == 0){
+  HgObjMaterial *material = NULL;
+  while(at < end && !parser->isError){
+    const char *line = hgObjSkipSpace(at, end);
+    const char *lineEnd = memchr(line, '\n', end - line);
+    if(lineEnd == NULL){
+      lineEnd = end;
+    }
+    at = lineEnd + 1;
+
+    if(hgObjIsKeyword(line, lineEnd, "newmtl")){
+      HgObjName name = hgObjAddName(parser, hgObjLineRest(line + 6, lineEnd));
+      material = hgObjArrayAdd(&parser->materials);
+      if(material == NULL){
+        parser->isError = true;
         break;
       }
-      //mtllib
-      if(strcmp(word, "mtllib") == 0){
-        word = strtok(NULL, "\n /");
-        snprintf(mtlFile, PATH_LENGTH, "res/models/%s", word); 
-      }
-      //usemtl
-      if(strcmp(word, "usemtl") == 0){
-        word = strtok(NULL, "\n /");
-        snprintf(usedMtl, PATH_LENGTH, "%s", word); 
-      }
+      material->name = name;
+      material->texture.len = 0;
+    }else if(material != NULL && hgObjIsKeyword(line, lineEnd, "map_Kd")){
+      material->texture = hgObjAddName(parser,
+                                       hgObjLineRest(line + 6, lineEnd));
+    }
+  }
+  hgUnmapFile(&mtlMap);
+}
 
-      //vertex
-      if(strcmp(word, "v") == 0){
-        for(int i = 0; i < 3; i++){
-          word = strtok(NULL, "\n /");
-          v[posIndex][i] = atof(word);
+/* Writes a blob to the bake, HG_MESH_ALIGN aligned. Returns its offset. If
+ * the write fails the bake is given up on, the load still goes on */
+uint64_t hgObjBakeWrite(HgObjParser *parser, const void *data, uint64_t size){
+  static const char zeros[HG_MESH_ALIGN] = {0};
+  if(parser->bake == NULL){
+    return 0;
+  }
+  uint64_t padding = (HG_MESH_ALIGN - parser->bakeSize % HG_MESH_ALIGN)
+                     % HG_MESH_ALIGN;
+  uint64_t offset = parser->bakeSize + padding;
+  if(fwrite(zeros, 1, padding, parser->bake) != padding
+     || fwrite(data, 1, size, parser->bake) != size){
+    HG_WARN("Failed writing %s, not baking it", parser->bakeHeader.obj.path);
+    fclose(parser->bake);
+    parser->bake = NULL;
+    return 0;
+  }
+  parser->bakeSize = offset + size;
+  return offset;
+}
+
+/* The object's verts and indices, as they go to the GPU */
+void hgObjBakeObject(HgObjParser *parser,
+                     const void *verts,
+                     uint32_t indSize,
+                     const vec3 boundsMin,
+                     const vec3 boundsMax,
+                     const HgMeshLod *lods,
+                     uint32_t lodCount){
+  HgMeshEntry *entry = hgObjArrayAdd(&parser->entries);
+  if(entry == NULL){
+    parser->isError = true;
+    return;
+  }
+  memset(entry, 0, sizeof(HgMeshEntry));
+  entry->layout = parser->layout;
+  entry->vertSize = hgVertexSize(parser->layout);
+  entry->vertCount = (uint32_t)parser->verts.count;
+  entry->indSize = indSize;
+  entry->indCount = (uint32_t)parser->inds.count;
+  entry->lodCount = lodCount;
+  memcpy(entry->lods, lods, lodCount * sizeof(HgMeshLod));
+  memcpy(entry->boundsMin, boundsMin, sizeof(entry->boundsMin));
+  memcpy(entry->boundsMax, boundsMax, sizeof(entry->boundsMax));
+
+  entry->vertOffset = hgObjBakeWrite(parser,
+                                     verts,
+                                     parser->verts.count * entry->vertSize);
+  entry->indOffset = hgObjBakeWrite(parser,
+                                    parser->inds.data,
+                                    parser->inds.count * indSize);
+}
+
+/* Entries and header go in last, once every object and its texture are
+ * known. Written to a temp file and renamed, so a half written bake is
+ * never loaded. Returns 0 if the bake was written */
+int hgObjFinishBake(HgObjParser *parser, const char *bakeFile){
+  HgMeshEntry *entries = (HgMeshEntry*)parser->entries.data;
+  HgObjObject *objects = (HgObjObject*)parser->objects.data;
+  bool isBakeable = parser->bake != NULL
+                    && !parser->isError
+                    && parser->entries.count == parser->objects.count;
+  for(uint64_t i = 0; isBakeable && i < parser->objects.count; i++){
+    if(objects[i].name.len >= HG_MESH_NAME_LENGTH
+       || objects[i].texture.len >= HG_MESH_PATH_LENGTH){
+      HG_WARN("Name too long to bake %s", parser->bakeHeader.obj.path);
+      isBakeable = false;
+      break;
+    }
+    memcpy(entries[i].name,
+           hgObjGetName(parser, objects[i].name),
+           objects[i].name.len + 1);
+    if(objects[i].texture.len > 0){
+      memcpy(entries[i].texture,
+             hgObjGetName(parser, objects[i].texture),
+             objects[i].texture.len + 1);
+    }
+  }
+
+  char tempFile[PATH_LENGTH];
+  snprintf(tempFile, PATH_LENGTH, "%s.tmp", bakeFile);
+  if(isBakeable){
+    parser->bakeHeader.magic = HG_MESH_MAGIC;
+    parser->bakeHeader.version = HG_MESH_VERSION;
+    parser->bakeHeader.meshCount = (uint32_t)parser->entries.count;
+    parser->bakeHeader.flags = (parser->layout == HG_VERTEX_COMPACT)
+                               ? HG_MESH_COMPACT : 0;
+    parser->bakeHeader.entriesOffset = hgObjBakeWrite(parser,
+        parser->entries.data,
+        parser->entries.count * sizeof(HgMeshEntry));
+  }
+  if(isBakeable){
+    isBakeable = parser->bake != NULL
+                 && fseek(parser->bake, 0, SEEK_SET) == 0
+                 && fwrite(&parser->bakeHeader,
+                           sizeof(HgMeshHeader), 1, parser->bake) == 1;
+  }
+  if(parser->bake != NULL){
+    isBakeable = (fclose(parser->bake) == 0) && isBakeable;
+    parser->bake = NULL;
+  }
+  if(!isBakeable || rename(tempFile, bakeFile) != 0){
+    remove(tempFile);
+    return -1;
+  }
+  return 0;
+}
+
+/* Adds the object's simpler LODs (see meshLod.c) after its indices.
+ * Returns the LOD count, the full mesh included */
+uint32_t hgObjAddLods(HgObjParser *parser, HgMeshLod *lods){
+  uint64_t indCount = parser->inds.count;
+  lods[0].indStart = 0;
+  lods[0].indCount = (uint32_t)indCount;
+  lods[0].error = 0.0f;
+  if(indCount > UINT32_MAX / 3){
+    return 1;
+  }
+
+  HgArenaMark mark = hgArenaGetMark(parser->fileArena);
+  uint64_t capacity = 2 * indCount;
+  uint32_t *lodInds = hgArenaPush(parser->fileArena,
+                                  capacity * sizeof(uint32_t));
+  uint32_t lodCount = 1;
+  if(lodInds != NULL){
+    lodCount = hgBuildMeshLods(parser->fileArena,
+                               (HgVertex*)parser->verts.data,
+                               (uint32_t)parser->verts.count,
+                               (uint32_t*)parser->inds.data,
+                               (uint32_t)indCount,
+                               lodInds,
+                               capacity,
+                               lods);
+  }
+  uint64_t lodIndCount = lods[lodCount - 1].indStart
+                         + lods[lodCount - 1].indCount - indCount;
+  for(uint64_t i = 0; lodCount > 1 && i < lodIndCount; i++){
+    uint32_t *ind = hgObjArrayAdd(&parser->inds);
+    if(ind == NULL){
+      /* still fine without them */
+      parser->inds.count = indCount;
+      lodCount = 1;
+      break;
+    }
+    *ind = lodInds[i];
+  }
+  hgArenaPopToMark(parser->fileArena, mark);
+
+  for(uint32_t i = 0; i < HG_MESH_MAX_LODS; i++){
+    parser->stats.lodTriCounts[i] += lods[MIN(i, lodCount - 1)].indCount / 3;
+  }
+  return lodCount;
+}
+
+/* The mesh made from the faces since the object started (if it's wanted),
+ * and a clean start for the next one */
+HgMesh* hgObjFinishObject(HgObjParser *parser, HgArena *arena, bool isWanted){
+  hgOptimizeMesh(parser->fileArena,
+                 (HgVertex*)parser->verts.data,
+                 (uint32_t)parser->verts.count,
+                 (uint32_t*)parser->inds.data,
+                 parser->inds.count,
+                 &parser->stats);
+  HgMeshLod lods[HG_MESH_MAX_LODS];
+  uint32_t lodCount = hgObjAddLods(parser, lods);
+  uint32_t indSize = hgObjNarrowIndices((uint32_t*)parser->inds.data,
+                                        parser->inds.count,
+                                        parser->verts.count);
+  HgVertex *verts = (HgVertex*)parser->verts.data;
+  uint32_t vertCount = (uint32_t)parser->verts.count;
+  vec3 boundsMin;
+  vec3 boundsMax;
+  hgMeshBounds(verts, vertCount, boundsMin, boundsMax);
+
+  /* the verts in the layout they go to the GPU in */
+  HgArenaMark mark = hgArenaGetMark(parser->fileArena);
+  const void *layoutVerts = verts;
+  if(parser->layout == HG_VERTEX_COMPACT){
+    HgCompactVertex *compact = hgArenaPush(parser->fileArena,
+                                           vertCount
+                                           * sizeof(HgCompactVertex));
+    if(compact == NULL){
+      parser->isError = true;
+      return NULL;
+    }
+    hgCompactVertices(verts, vertCount, boundsMin, boundsMax, compact);
+    layoutVerts = compact;
+  }
+
+  HgMesh *mesh = NULL;
+#ifndef HG_OBJ_BAKE_ONLY
+  if(isWanted){
+    mesh = hgArenaPush(arena, sizeof(HgMesh));
+    if(mesh == NULL){
+      parser->isError = true;
+      hgArenaPopToMark(parser->fileArena, mark);
+      return NULL;
+    }
+    memset(mesh, 0, sizeof(HgMesh));
+    hgCreateMeshVertexBufferEx(mesh,
+                               layoutVerts,
+                               parser->layout,
+                               vertCount,
+                               parser->inds.data,
+                               parser->inds.count,
+                               indSize,
+                               boundsMin,
+                               boundsMax); 
+    hgSetMeshLods(mesh, lods, lodCount);
+  }
+#else
+  (void)(arena);
+  (void)(isWanted);
+#endif /* HG_OBJ_BAKE_ONLY */
+  if(parser->bake != NULL){
+    hgObjBakeObject(parser, layoutVerts, indSize, boundsMin, boundsMax,
+                    lods, lodCount);
+  }
+  hgArenaPopToMark(parser->fileArena, mark);
+
+  parser->verts.count = 0;
+  parser->inds.count = 0;
+  if(hgObjCornersClear(&parser->corners)){
+    parser->isError = true;
+  }
+  return mesh;
+}
+
+int hgObjStartObject(HgObjParser *parser, HgObjName name){
+  HgObjObject *object = hgObjArrayAdd(&parser->objects);
+  if(object == NULL){
+    parser->isError = true;
+    return -1;
+  }
+  object->name = name;
+  object->material.len = 0;
+  object->texture.len = 0;
+  object->mesh = NULL;
+  return 0;
+}
+
+/* Does the object get a mesh? */
+bool hgObjIsWanted(HgObjParser *parser, HgObjWord name, const char *onlyObject){
+  return !parser->isBakeOnly
+         && (onlyObject == NULL || hgObjWordIs(name, onlyObject));
+}
+
+/* One pass over the whole file, a line at a time, making a mesh for each
+ * object. v/vt/vn are numbered across the whole file, so they're shared
+ * by every object. With onlyObject set, only that object gets a mesh. The
+ * other objects' faces are skipped, and the parse stops when that object
+ * is done, unless the whole file is being baked. Faces before the first
+ * 'o' are an object named defaultName. Objects with no faces are dropped */
+void hgObjParse(HgObjParser *parser,
+                HgArena *arena,
+                const char *objFile,
+                const char *defaultName,
+                const char *onlyObject){
+  (void)(objFile); /* only used to log, which release builds don't */
+  char mtlFile[PATH_LENGTH] = {0};
+
+  HgObjWord defaultWord = {defaultName, strlen(defaultName)};
+  HgObjObject *object = NULL;
+  bool isInObject = false;  /* between an 'o' (or the first face) and the next */
+  bool isWanted = false;  /* gets a mesh */
+  bool isKept = false;    /* gets a mesh or is baked */
+
+  uint64_t lineNumber = 0;
+  while(parser->at < parser->end && !parser->isError){
+    const char *line = hgObjSkipSpace(parser->at, parser->end);
+    const char *lineEnd = memchr(line, '\n', parser->end - line);
+    if(lineEnd == NULL){
+      lineEnd = parser->end;
+    }
+    parser->at = lineEnd + 1;
+    lineNumber++;
+
+    if(hgObjIsKeyword(line, lineEnd, "v")){
+      float *v = hgObjArrayAdd(&parser->pos);
+      const char *at = line + 1;
+      for(int i = 0; v != NULL && i < 3; i++){
+        if(hgObjParseFloat(&at, lineEnd, &v[i])){
+          HG_ERROR("Bad number in %s on line %llu",
+                   objFile, (unsigned long long)lineNumber);
+          v = NULL;
         }
-        posIndex++;
       }
-      //texture
-      if(strcmp(word, "vt") == 0){
-        for(int i = 0; i < 2; i++){
-          word = strtok(NULL, "\n /");
-          vt[texIndex][i] = atof(word);
+      parser->isError = (v == NULL);
+    }else if(hgObjIsKeyword(line, lineEnd, "vt")){
+      float *vt = hgObjArrayAdd(&parser->tex);
+      const char *at = line + 2;
+      for(int i = 0; vt != NULL && i < 2; i++){
+        if(hgObjParseFloat(&at, lineEnd, &vt[i])){
+          HG_ERROR("Bad number in %s on line %llu",
+                   objFile, (unsigned long long)lineNumber);
+          vt = NULL;
         }
-        texIndex++;
       }
-      //norm
-      if(strcmp(word, "vn") == 0){
-        for(int i = 0; i < 3; i++){
-          word = strtok(NULL, "\n /");
-          vn[normIndex][i] = atof(word);
+      parser->isError = (vt == NULL);
+    }else if(hgObjIsKeyword(line, lineEnd, "vn")){
+      float *vn = hgObjArrayAdd(&parser->norm);
+      const char *at = line + 2;
+      for(int i = 0; vn != NULL && i < 3; i++){
+        if(hgObjParseFloat(&at, lineEnd, &vn[i])){
+          HG_ERROR("Bad number in %s on line %llu",
+                   objFile, (unsigned long long)lineNumber);
+          vn = NULL;
         }
-        normIndex++;
       }
-      if(strcmp(word, "vp") == 0){
-        HG_WARN("vp not supported in obj parsing yet");
+      parser->isError = (vn == NULL);
+    }else if(hgObjIsKeyword(line, lineEnd, "f")
+             || hgObjIsKeyword(line, lineEnd, "usemtl")){
+      if(!isInObject){
+        isInObject = true;
+        isWanted = hgObjIsWanted(parser, defaultWord, onlyObject);
+        isKept = isWanted || parser->bake != NULL;
+        if(isKept
+           && hgObjStartObject(parser, hgObjAddName(parser, defaultWord))){
+          break;
+        }
       }
-      //face
-      if(strcmp(word, "f") == 0){
-        //Only tris supported
-        for(int i = 0; i < 3; i++){
-          word = strtok(NULL, "\n /");
-          int posInd = atoi(word) - 1; 
-          inds[indsIndex++] =  vertIndex;
-          verts[vertIndex].position[0] = v[posInd][0];
-          verts[vertIndex].position[1] = v[posInd][1];
-          verts[vertIndex].position[2] = v[posInd][2];
-
-          if(counts.texs > 0){
-            word = strtok(NULL, "\n /");
-            int texInd = atoi(word) - 1;
-            verts[vertIndex].texture[0] = vt[texInd][0];
-            verts[vertIndex].texture[1] = vt[texInd][1];
-          }
-
-          if(counts.norms > 0){
-            word = strtok(NULL, "\n /");
-            int normInd = atoi(word) - 1;
-            verts[vertIndex].normal[0] = vn[normInd][0];
-            verts[vertIndex].normal[1] = vn[normInd][1];
-            verts[vertIndex].normal[2] = vn[normInd][2];
-
+      if(!isKept){
+        continue;
+      }
+      object = (HgObjObject*)parser->objects.data + parser->objects.count - 1;
+      if(line[0] == 'u'){
+        object->material = hgObjAddName(parser,
+                                        hgObjLineRest(line + 6, lineEnd));
+      }else if(hgObjAddFace(parser, line + 1, lineEnd)){
+        HG_ERROR("Bad face in %s on line %llu",
+                 objFile, (unsigned long long)lineNumber);
+        parser->isError = true;
+      }
+    }else if(hgObjIsKeyword(line, lineEnd, "o")){
+      if(isInObject && isKept){
+        if(parser->inds.count == 0){
+          parser->objects.count--; /* no faces, nothing to draw */
+        }else{
+          object = (HgObjObject*)parser->objects.data
+                   + parser->objects.count - 1;
+          object->mesh = hgObjFinishObject(parser, arena, isWanted);
+          if(isWanted && onlyObject != NULL && parser->bake == NULL){
+            isInObject = false;
+            break; /* the next object, ours is done */
           }
-          vertIndex++;
         }
       }
-
-    }else{ //find object
-      if(strcmp(word, "mtllib") == 0){
-        word = strtok(NULL, "\n /");
-        snprintf(mtlFile, PATH_LENGTH, "res/models/%s", word); 
+      HgObjWord name = hgObjLineRest(line + 1, lineEnd);
+      isInObject = true;
+      isWanted = hgObjIsWanted(parser, name, onlyObject);
+      isKept = isWanted || parser->bake != NULL;
+      if(isKept){
+        hgObjStartObject(parser, hgObjAddName(parser, name));
       }
-      if(strcmp(word, "o") == 0){
-        word = strtok(NULL, "\n /");
-        if(strcmp(word, object) == 0){
-          objFound = true;
-        }
+    }else if(hgObjIsKeyword(line, lineEnd, "mtllib")){
+      HgObjWord word = hgObjLineRest(line + 6, lineEnd);
+      snprintf(mtlFile, PATH_LENGTH, "res/models/%.*s",
+               (int)word.len, word.str); 
+    }else if(hgObjIsKeyword(line, lineEnd, "vp")){
+      HG_WARN("vp not supported in obj parsing yet");
+    }
+  }
+
+  if(isInObject && isKept && !parser->isError){
+    if(parser->inds.count == 0){
+      parser->objects.count--;
+    }else{
+      object = (HgObjObject*)parser->objects.data + parser->objects.count - 1;
+      object->mesh = hgObjFinishObject(parser, arena, isWanted);
+    }
+  }
+
+  /* one mtl parse for every object */
+  if(!parser->isError && mtlFile[0] != '\0'){
+    hgObjLoadMaterials(parser, mtlFile);
+  }
+  HgObjObject *objects = (HgObjObject*)parser->objects.data;
+  HgObjMaterial *materials = (HgObjMaterial*)parser->materials.data;
+  for(uint64_t i = 0; i < parser->objects.count && !parser->isError; i++){
+    for(uint64_t j = 0; j < parser->materials.count; j++){
+      if(objects[i].material.len > 0
+         && hgObjNameIs(parser, objects[i].material, materials[j].name)){
+        objects[i].texture = materials[j].texture;
+        break;
       }
     }
-    word = strtok(NULL, "\n /");
+#ifndef HG_OBJ_BAKE_ONLY
+    if(objects[i].mesh != NULL && objects[i].texture.len > 0){
+      hgLoadMeshTexture(objects[i].mesh,
+                        (char*)hgObjGetName(parser, objects[i].texture));
+    }
+#endif /* HG_OBJ_BAKE_ONLY */
+  }
+}
+
+/* Only what loading a bake needs, the per vertex arrays wait for
+ * hgObjParserMap to know how big the obj is */
+int hgObjParserInit(HgObjParser *parser, const char *objFile){
+  (void)(objFile); /* only used to log */
+  memset(parser, 0, sizeof(HgObjParser));
+  parser->layout = HG_OBJ_LAYOUT;
+  parser->fileArena = hgCreateArenaEx(HG_OBJ_SCRATCH_MIN,
+                                      4,
+                                      HGL_ARENA_VIRTUAL | HGL_ARENA_GROWABLE);
+  if(parser->fileArena == NULL
+     || hgObjArrayInit(&parser->names, sizeof(char), HG_OBJ_SCRATCH_MIN)
+     || hgObjArrayInit(&parser->objects, sizeof(HgObjObject),
+                       HG_OBJ_SCRATCH_MIN)
+     || hgObjArrayInit(&parser->materials, sizeof(HgObjMaterial),
+                       HG_OBJ_SCRATCH_MIN)
+     || hgObjArrayInit(&parser->entries, sizeof(HgMeshEntry),
+                       HG_OBJ_SCRATCH_MIN)){
+    HG_ERROR("Out of Memory, Can't parse %s", objFile);
+    parser->isError = true;
+    return -1;
+  }
+  return 0;
+}
+
+/* Maps the obj to be parsed, and makes the per vertex arrays for it.
+ * data is NULL if that failed */
+HgFileMap hgObjParserMap(HgObjParser *parser, const char *objFile){
+  HgFileMap objMap = hgMapFileEx(parser->fileArena, objFile);
+  if(objMap.data == NULL){
+    parser->isError = true;
+    return objMap;
+  }
+  uint64_t reserve = MAX(objMap.size * HG_OBJ_SCRATCH_SCALE,
+                         (uint64_t)HG_OBJ_SCRATCH_MIN);
+  if(hgObjArrayInit(&parser->pos, sizeof(vec3), reserve)
+     || hgObjArrayInit(&parser->tex, sizeof(vec2), reserve)
+     || hgObjArrayInit(&parser->norm, sizeof(vec3), reserve)
+     || hgObjArrayInit(&parser->verts, sizeof(HgVertex), reserve)
+     || hgObjArrayInit(&parser->inds, sizeof(uint32_t), reserve)
+     || hgObjCornersInit(&parser->corners, reserve)){
+    HG_ERROR("Out of Memory, Can't parse %s", objFile);
+    parser->isError = true;
+    hgUnmapFile(&objMap);
+    return objMap;
+  }
+  parser->at = objMap.data;
+  parser->end = objMap.data + objMap.size;
+  return objMap;
+}
+
+void hgObjParserDestroy(HgObjParser *parser){
+  if(parser->bake != NULL){
+    fclose(parser->bake);
+  }
+  hgObjArrayDestroy(&parser->pos);
+  hgObjArrayDestroy(&parser->tex);
+  hgObjArrayDestroy(&parser->norm);
+  hgObjArrayDestroy(&parser->verts);
+  hgObjArrayDestroy(&parser->inds);
+  hgObjCornersDestroy(&parser->corners);
+  hgObjArrayDestroy(&parser->names);
+  hgObjArrayDestroy(&parser->objects);
+  hgObjArrayDestroy(&parser->materials);
+  hgObjArrayDestroy(&parser->entries);
+  if(parser->fileArena != NULL){
+    hgDestroyArena(parser->fileArena);
+  }
+}
+
+/* Starts writing the bake of the mapped obj, to a temp file. Objs only in
+ * the .hgpak aren't baked, there's nowhere to put it */
+void hgObjStartBake(HgObjParser *parser,
+                    const char *objFile,
+                    const char *bakeFile,
+                    const HgFileMap *objMap){
+  char tempFile[PATH_LENGTH];
+  snprintf(tempFile, PATH_LENGTH, "%s.tmp", bakeFile);
+  if(!objMap->isInPak){
+    parser->bake = fopen(tempFile, "wb");
+  }
+  if(parser->bake != NULL){
+    /* filled in at the end */
+    hgObjBakeWrite(parser, &parser->bakeHeader, sizeof(HgMeshHeader));
+    hgStampBakeSource(&parser->bakeHeader.obj, objFile, objMap);
+  }
+}
+
+/* Bakes every object in the obj without making any meshes, for hgbake.
+ * Verts are baked in layout. Adds how much hgOptimizeMesh helped, and the
+ * LODs' triangles, to stats.
+ * Returns 0 on success */
+int hgObjBake(const char *objFile,
+              const char *bakeFile,
+              const char *defaultName,
+              uint32_t layout,
+              HgMeshStats *stats){
+  HgObjParser parser;
+  if(hgObjParserInit(&parser, objFile)){
+    hgObjParserDestroy(&parser);
+    return -1;
+  }
+  parser.isBakeOnly = true;
+  parser.layout = layout;
+
+  int result = -1;
+  HgFileMap objMap = hgObjParserMap(&parser, objFile);
+  if(objMap.data != NULL){
+    hgObjStartBake(&parser, objFile, bakeFile, &objMap);
+    if(parser.bake != NULL){
+      hgObjParse(&parser, NULL, objFile, defaultName, NULL);
+      result = hgObjFinishBake(&parser, bakeFile);
+      hgAddMeshStats(stats, &parser.stats);
+    }
+  }
+  hgUnmapFile(&objMap);
+  hgObjParserDestroy(&parser);
+  return result;
+}
+
+#ifndef HG_OBJ_BAKE_ONLY
+
+/* Is every index under vertCount? Baked indices go straight to the GPU,
+ * which won't stop one reading past the vertices */
+bool hgObjIsIndexRangeValid(const uint8_t *inds,
+                            uint32_t indCount,
+                            uint32_t indSize,
+                            uint32_t vertCount){
+  uint32_t maxInd = 0;
+  for(uint32_t i = 0; i < indCount; i++){
+    uint32_t ind;
+    if(indSize == sizeof(uint16_t)){
+      uint16_t ind16;
+      memcpy(&ind16, inds + (uint64_t)i * indSize, sizeof(ind16));
+      ind = ind16;
+    }else{
+      memcpy(&ind, inds + (uint64_t)i * indSize, sizeof(ind));
+    }
+    maxInd = MAX(maxInd, ind);
+  }
+  return indCount == 0 || maxInd < vertCount;
+}
+
+/* Meshes straight from a baked .hgmesh, the mapped verts and indices go to
+ * the GPU as they are. Returns false if there's no bake, or it's stale */
+bool hgObjLoadBaked(HgObjParser *parser,
+                    HgArena *arena,
+                    const char *bakeFile,
+                    const char *onlyObject){
+  if(!hgFileExists(bakeFile)){
+    return false;
+  }
+  HgFileMap bakeMap = hgMapFile(bakeFile);
+  if(bakeMap.data == NULL){
+    return false;
   }
 
+  const HgMeshHeader *header = (const HgMeshHeader*)bakeMap.data;
+  const HgMeshEntry *entries = NULL;
+  bool isUsable = bakeMap.size >= sizeof(HgMeshHeader)
+                  && header->magic == HG_MESH_MAGIC
+                  && header->version == HG_MESH_VERSION
+                  && header->entriesOffset <= bakeMap.size
+                  && header->meshCount <= (bakeMap.size - header->entriesOffset)
+                                          / sizeof(HgMeshEntry);
+  if(isUsable){
+    entries = (const HgMeshEntry*)(bakeMap.data + header->entriesOffset);
+  }
+  /* a bad bake is ignored (and rebaked), never read out of bounds */
+  for(uint32_t i = 0; isUsable && i < header->meshCount; i++){
+    const HgMeshEntry *entry = &entries[i];
+    isUsable = entry->layout < HG_VERTEX_LAYOUT_COUNT
+               && entry->vertSize == hgVertexSize(entry->layout)
+               && (entry->indSize == sizeof(uint16_t)
+                   || entry->indSize == sizeof(uint32_t))
+               && memchr(entry->name, '\0', HG_MESH_NAME_LENGTH) != NULL
+               && memchr(entry->texture, '\0', HG_MESH_PATH_LENGTH) != NULL
+               && entry->vertOffset <= bakeMap.size
+               && entry->vertCount <= (bakeMap.size - entry->vertOffset)
+                                      / entry->vertSize
+               && entry->indOffset <= bakeMap.size
+               && entry->indCount <= (bakeMap.size - entry->indOffset)
+                                     / entry->indSize
+               && entry->indCount > 0
+               && entry->lodCount >= 1
+               && entry->lodCount <= HG_MESH_MAX_LODS;
+    for(uint32_t j = 0; isUsable && j < entry->lodCount; j++){
+      isUsable = entry->lods[j].indStart <= entry->indCount
+                 && entry->lods[j].indCount
+                    <= entry->indCount - entry->lods[j].indStart;
+    }
+    isUsable = isUsable
+               && hgObjIsIndexRangeValid((const uint8_t*)bakeMap.data
+                                         + entry->indOffset,
+                                         entry->indCount,
+                                         entry->indSize,
+                                         entry->vertCount);
+  }
+  if(!isUsable){
+    HG_WARN("Bad baked mesh %s, using the obj", bakeFile);
+  }else if(!hgIsBakeSourceFresh(&header->obj)
+           || !hgIsBakeSourceFresh(&header->mtl)){
+    HG_LOG("Baked mesh %s is stale, using the obj", bakeFile);
+    isUsable = false;
+    /* rebaked the way it was baked */
+    parser->layout = (header->flags & HG_MESH_COMPACT) ? HG_VERTEX_COMPACT
+                                                       : HG_VERTEX_FLOAT;
+  }
+  if(!isUsable){
+    hgUnmapFile(&bakeMap);
+    return false;
+  }
+
+  for(uint32_t i = 0; i < header->meshCount && !parser->isError; i++){
+    const HgMeshEntry *entry = &entries[i];
+    if(onlyObject != NULL && strcmp(entry->name, onlyObject) != 0){
+      continue;
+    }
+    HgObjWord name = {entry->name, strlen(entry->name)};
+    HgMesh *mesh = hgArenaPush(arena, sizeof(HgMesh));
+    if(mesh == NULL || hgObjStartObject(parser, hgObjAddName(parser, name))){
+      parser->isError = true;
+      break;
+    }
+    memset(mesh, 0, sizeof(HgMesh));
+    hgCreateMeshVertexBufferEx(mesh,
+                               bakeMap.data + entry->vertOffset,
+                               entry->layout,
+                               entry->vertCount,
+                               bakeMap.data + entry->indOffset,
+                               entry->indCount,
+                               entry->indSize,
+                               entry->boundsMin,
+                               entry->boundsMax);
+    hgSetMeshLods(mesh, entry->lods, entry->lodCount);
+    if(entry->texture[0] != '\0'){
+      hgLoadMeshTexture(mesh, (char*)entry->texture);
+    }
+    ((HgObjObject*)parser->objects.data)[parser->objects.count - 1].mesh = mesh;
+    if(onlyObject != NULL){
+      break;
+    }
+  }
+  hgUnmapFile(&bakeMap);
+  return true;
+}
+
+/* Fills in parser->objects, from res/models/file.obj.hgmesh if it's up to
+ * date, otherwise from res/models/file.obj. A loose obj is baked while
+ * it's parsed, so the next load can skip parsing */
+void hgObjLoad(HgObjParser *parser,
+               HgArena *arena,
+               const char *file,
+               const char *onlyObject){
+  char objFile[PATH_LENGTH] = {0};
+  char bakeFile[PATH_LENGTH] = {0};
+  snprintf(objFile, PATH_LENGTH, "res/models/%s.obj", file);
+
   if(meshShader.program == 0){
     meshShader = hgCreateShader(arena, MESH_SHADER_FILE);
   }
-  
-  hgCreateMeshVertexBuffer(mesh,
-                           verts,
-                           counts.verts,
-                           inds,
-                           counts.inds
-                           ); 
-  
-  hgArenaPop(arena, objBuffer, objSize);
-  hgArenaPop(arena, inds, counts.inds * sizeof(uint16_t));
-  hgArenaPop(arena, verts, counts.verts * sizeof(HgVertex));
-  hgArenaPop(arena, vn, counts.norms * sizeof(vec3));
-  hgArenaPop(arena, vt, counts.texs * sizeof(vec2));
-  hgArenaPop(arena, v, counts.verts * sizeof(vec3));
-
-  hgGetMtlTexture(arena, mesh, mtlFile, usedMtl);
 
+  if(hgObjParserInit(parser, objFile)){
+    return;
+  }
+  if(hgBakePath(bakeFile, PATH_LENGTH, objFile, ".hgmesh")){
+    HG_ERROR("Path too long, can't load %s", objFile);
+    parser->isError = true;
+    return;
+  }
+  if(hgObjLoadBaked(parser, arena, bakeFile, onlyObject)){
+    return;
+  }
+
+  HgFileMap objMap = hgObjParserMap(parser, objFile);
+  if(objMap.data == NULL){
+    return;
+  }
+
+  hgObjStartBake(parser, objFile, bakeFile, &objMap);
+  bool isBaking = (parser->bake != NULL);
+  hgObjParse(parser, arena, objFile, file, onlyObject);
+  if(parser->stats.triCount > 0){
+    HG_LOG("Optimized %s, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", objFile,
+           hgMeshAcmr(&parser->stats, parser->stats.missesBefore),
+           hgMeshAcmr(&parser->stats, parser->stats.missesAfter),
+           hgMeshAtvr(&parser->stats, parser->stats.missesBefore),
+           hgMeshAtvr(&parser->stats, parser->stats.missesAfter));
+    char lodText[HG_LOD_TEXT_LENGTH];
+    hgMeshLodText(&parser->stats, lodText, sizeof(lodText));
+    HG_LOG("LODs of %s, %s triangles", objFile, lodText);
+  }
+  if(isBaking){
+    hgObjFinishBake(parser, bakeFile);
+  }
+  hgUnmapFile(&objMap);
+}
+
+HgMesh* hgLoadObjMesh(HgArena *arena,
+                      const char* file,
+                      const char* object){
+
+  const char *oldTag = hgArenaSetTag(arena, "mesh");
+
+  HgObjParser parser;
+  hgObjLoad(&parser, arena, file, object);
+
+  /* baking keeps every object, only ours has a mesh */
+  HgMesh *mesh = NULL;
+  HgObjObject *objects = (HgObjObject*)parser.objects.data;
+  for(uint64_t i = 0; i < parser.objects.count && mesh == NULL; i++){
+    mesh = objects[i].mesh;
+  }
+  if(parser.isError){
+    HG_ERROR("Failed to load %s", file);
+  }else if(mesh == NULL){
+    HG_WARN("No object %s in %s", object, file);
+  }
+  hgObjParserDestroy(&parser);
+
+  /* still a mesh, just nothing to draw */
+  if(mesh == NULL){
+    mesh = hgArenaPush(arena, sizeof(HgMesh));
+    memset(mesh, 0, sizeof(HgMesh));
+    hgCreateMeshVertexBuffer(mesh, NULL, 0, NULL, 0, sizeof(uint16_t));
+  }
+
+  hgArenaSetTag(arena, oldTag);
   return mesh;
 }
+
+HgObjFile* hgLoadObjFile(HgArena *arena, const char* file){
+
+  const char *oldTag = hgArenaSetTag(arena, "mesh");
+  HgArenaMark mark = hgArenaGetMark(arena);
+
+  HgObjParser parser;
+  hgObjLoad(&parser, arena, file, NULL);
+  uint32_t meshCount = (uint32_t)parser.objects.count;
+  uint32_t bucketCount = 1;
+  while(bucketCount < meshCount * 2){
+    bucketCount *= 2;
+  }
+
+  HgObjFile *objs = NULL;
+  if(!parser.isError){
+    objs = hgArenaPush(arena, sizeof(HgObjFile));
+    char *names = hgArenaPush(arena, parser.names.count + 1);
+    if(objs != NULL && names != NULL){
+      objs->meshCount = meshCount;
+      objs->bucketCount = bucketCount;
+      objs->names = hgArenaPush(arena, (meshCount + 1) * sizeof(char*));
+      objs->meshes = hgArenaPush(arena, (meshCount + 1) * sizeof(HgMesh*));
+      objs->buckets = hgArenaPush(arena, bucketCount * sizeof(uint32_t));
+    }
+    if(objs == NULL || names == NULL || objs->names == NULL
+       || objs->meshes == NULL || objs->buckets == NULL){
+      HG_ERROR("Out of Memory, Can't load %s", file);
+      parser.isError = true;
+    }else{
+      memcpy(names, parser.names.data, parser.names.count);
+      memset(objs->buckets, 0, bucketCount * sizeof(uint32_t));
+
+      HgObjObject *objects = (HgObjObject*)parser.objects.data;
+      for(uint32_t i = 0; i < meshCount; i++){
+        objs->names[i] = names + objects[i].name.offset;
+        objs->meshes[i] = objects[i].mesh;
+
+        /* a later object with the same name can't be found */
+        uint32_t bucket = hgPakHash(objs->names[i]) & (bucketCount - 1);
+        while(objs->buckets[bucket] != 0){
+          bucket = (bucket + 1) & (bucketCount - 1);
+        }
+        objs->buckets[bucket] = i + 1;
+      }
+    }
+  }
+
+  if(parser.isError){
+    HG_ERROR("Failed to load %s", file);
+    HgObjObject *objects = (HgObjObject*)parser.objects.data;
+    for(uint64_t i = 0; i < parser.objects.count; i++){
+      if(objects[i].mesh != NULL){
+        hgCleanupVertexBuffer(&objects[i].mesh->vb);
+        hgCleanupTexture(&objects[i].mesh->t);
+      }
+    }
+    hgArenaPopToMark(arena, mark);
+    objs = NULL;
+  }
+  hgObjParserDestroy(&parser);
+
+  hgArenaSetTag(arena, oldTag);
+  return objs;
+}
+
+HgMesh* hgObjFileMesh(HgObjFile *objs, const char* object){
+  uint32_t bucket = hgPakHash(object) & (objs->bucketCount - 1);
+  while(objs->buckets[bucket] != 0){
+    uint32_t i = objs->buckets[bucket] - 1;
+    if(strcmp(objs->names[i], object) == 0){
+      return objs->meshes[i];
+    }
+    bucket = (bucket + 1) & (objs->bucketCount - 1);
+  }
+  return NULL;
+}
+
+void hgCleanupObjFile(HgObjFile *objs){
+  for(uint32_t i = 0; i < objs->meshCount; i++){
+    hgCleanupVertexBuffer(&objs->meshes[i]->vb);
+    hgCleanupTexture(&objs->meshes[i]->t);
+  }
+}
+
+#endif /* HG_OBJ_BAKE_ONLY */
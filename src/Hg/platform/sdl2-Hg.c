@@ -1,3 +1,6 @@
+/* Linux/POSIX extensions (mmap flags, madvise, ...) */
+#define _GNU_SOURCE
+
 #include "../Hg.c"
 
 #include "file.c"
@@ -6,6 +9,8 @@
 #include <SDL2/SDL.h>
 
 #include "gl/gl.c"
+#include "meshOpt.c"
+#include "meshLod.c"
 #include "objLoad.c"
 
 //POSIX
@@ -31,14 +36,56 @@ void hgUnloadGameCode(HgGameCode *gameCode){
   gameCode->hgEndGame = &hgEndGameStub;
 }
 
+/* dlopen a copy of the game shared object, so the build can overwrite it.
+ * On Linux the copy is an anonymous memory file opened through /proc. Its
+ * path is new every load (so dlopen never returns the cached old library),
+ * and nothing is written to disk. Otherwise it's copied to a temp file. */
+void* hgOpenGameSo(void){
+#ifdef __linux__
+  int srcFd = open(SO_FILENAME, O_RDONLY);
+  int memFd = memfd_create(SO_FILENAME, MFD_CLOEXEC);
+  struct stat srcStat;
+  if(srcFd != -1 && memFd != -1 && fstat(srcFd, &srcStat) == 0
+     && hgCopyFileFd(srcFd, memFd, srcStat.st_size) == 0){
+    char soPath[PATH_LENGTH];
+    snprintf(soPath, PATH_LENGTH, "/proc/self/fd/%d", memFd);
+    void *so = dlopen(soPath, RTLD_LOCAL | RTLD_NOW);
+    if(so == NULL){
+      HG_ERROR("Failed to load %s: %s", SO_FILENAME, dlerror());
+    }
+    /* The library stays mapped after the fd is closed */
+    close(srcFd);
+    close(memFd);
+    return so;
+  }
+  HG_WARN("Can't load %s from memory, using %s", SO_FILENAME, SO_FILENAME_TEMP);
+  if(srcFd != -1){
+    close(srcFd);
+  }
+  if(memFd != -1){
+    close(memFd);
+  }
+#endif /* __linux__ */
+
+  hgCopyFile(SO_FILENAME, SO_FILENAME_TEMP);
+  void *so = dlopen(SO_FILE_TEMP, RTLD_LOCAL | RTLD_NOW);
+  if(so == NULL){
+    HG_ERROR("Failed to load %s: %s", SO_FILENAME_TEMP, dlerror());
+  }
+  return so;
+}
+
 /* Load game shared object (DLL), and get function pointers for gameCode */
 void hgLoadGameCode(HgGameCode *gameCode){
   gameCode->isValid = false;
-  hgCopyFile(SO_FILENAME, SO_FILENAME_TEMP);
+  gameCode->isReloadPending = false;
   gameCode->modTime = hgFileModTime(SO_FILENAME);
-  gameCode->so = dlopen(SO_FILE_TEMP, RTLD_LOCAL | RTLD_NOW);
+  /* The directory is watched, the linker replaces the file itself */
+  if(gameCode->watchId <= 0){
+    gameCode->watchId = hgWatchFile(".");
+  }
+  gameCode->so = hgOpenGameSo();
   if(gameCode->so == NULL){
-    HG_ERROR("Failed to load %s: %s", SO_FILENAME_TEMP, dlerror());
     return;
   }
   
@@ -58,6 +105,7 @@ void hgLoadGameCode(HgGameCode *gameCode){
 
   gameCode->hgGameLoop = 
       (void (*)(HgArena *arena,
+                HgArena *frameArena,
                 HgGameState *gs,
                 HgInput *input,
                 double delta))
@@ -77,6 +125,19 @@ void hgLoadGameCode(HgGameCode *gameCode){
 
 /* Check if game shared object (DLL) was recently updated */
 bool hgCheckGameHotLoad(HgGameCode *gameCode){
+  if(gameCode->watchId > 0){
+    uint32_t count = 0;
+    const HgFileChange *changes = hgGetFileChanges(&count);
+    for(uint32_t i = 0; i < count; i++){
+      if(changes[i].watchId == gameCode->watchId
+         && strcmp(changes[i].name, SO_FILENAME) == 0){
+        gameCode->isReloadPending = true;
+      }
+    }
+    return gameCode->isReloadPending;
+  }
+
+  /* No file watching, poll instead */
   time_t nowTime = hgFileModTime(SO_FILENAME);
   double diff = difftime(nowTime, gameCode->modTime);
   if (diff > 0.5){
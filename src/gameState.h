@@ -12,6 +12,9 @@
 struct HgGameState {
  
   /* Add whatever thing you need here */
+  HgArenaMark startMark;
+  HgPool *entityPool;
+
   HgCamera *camera;
 
   HgLight *light;
@@ -28,8 +28,11 @@ HgVersionInfo hgGetVersionInfo(void){
 void hgStartGame(HgArena *arena, HgGameState *gs){
 
   /* Allocating memory */
-  gs->hgSymbol = hgArenaPush(arena, sizeof(HgEntity));
-  gs->hgPlanet = hgArenaPush(arena, sizeof(HgEntity));
+  gs->startMark = hgArenaGetMark(arena);
+  gs->entityPool = hgCreatePool(arena, sizeof(HgEntity), 64);
+
+  gs->hgSymbol = hgPoolAlloc(gs->entityPool);
+  gs->hgPlanet = hgPoolAlloc(gs->entityPool);
   gs->camera = hgArenaPush(arena, sizeof(HgCamera));
   gs->rot = hgArenaPush(arena, sizeof(float));
   gs->light = hgArenaPush(arena, sizeof(HgLight));
@@ -63,11 +66,13 @@ void hgStartGame(HgArena *arena, HgGameState *gs){
 }
 
 void hgGameLoop(HgArena *arena,
+                HgArena *frameArena,
                 HgGameState *gs,
                 HgInput *input,
                 double delta){
 
   (void)(arena);
+  (void)(frameArena);
 
   *gs->rot = 0;
   *gs->rot += input->right.isEndDown ? -3.0 : 0.0;
@@ -85,10 +90,11 @@ void hgGameLoop(HgArena *arena,
 void hgEndGame(HgArena *arena, HgGameState *gs){
   hgCleanupMesh(arena, gs->hgPlanetMesh);
   hgCleanupMesh(arena, gs->hgSymbolMesh);
-  
-  hgArenaPop(arena, gs->light, sizeof(HgLight));
-  hgArenaPop(arena, gs->rot, sizeof(float));
-  hgArenaPop(arena, gs->camera, sizeof(HgCamera));
-  hgArenaPop(arena, gs->hgPlanet, sizeof(HgEntity)); 
-  hgArenaPop(arena, gs->hgSymbol, sizeof(HgEntity));
+
+  /* Entities can go back to the pool in any order */
+  hgPoolFree(gs->entityPool, gs->hgSymbol);
+  hgPoolFree(gs->entityPool, gs->hgPlanet);
+
+  /* Pops the pool and everything else pushed in hgStartGame */
+  hgArenaPopToMark(arena, gs->startMark);
 }
@@ -0,0 +1,660 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: Bakes assets into files the engine uses as they are, with no
+ *  text parsing or image decoding (see Hg/platform/hgbake.h and hgmesh.h):
+ *    .obj and its .mtl    -> .hgmesh, with simpler LODs of each mesh
+ *    .png .jpg .tga .bmp  -> .hgtex, RGBA8 with every mip
+ *    .vert .frag          -> .hgvert .hgfrag, includes resolved and
+ *                            comments removed
+ *  Bakes go next to their sources, and keep the paths of their sources, so
+ *  run it from the same directory the game runs from.
+ *
+ *  Files are baked in parallel. A bake is only redone if the contents of a
+ *  file it was made from changed.
+ *
+ *  Usage: hgbake [-f] [-c] [-j jobs] res [more directories or files...]
+ *    -f : bake everything, even bakes that are up to date
+ *    -c : bake meshes in HG_VERTEX_COMPACT, half the vertex memory
+ *    -j : files baked at once, one per core by default
+ */
+
+/* nftw, Linux mmap flags */
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//POSIX
+#include <ftw.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../Hg/Hg.h"
+#define HGL_LOG_IMPLEMENTATION
+#include "../Hg/HgL_Log.h"
+#define HGL_ARENA_IMPLEMENTATION
+#include "../Hg/HgL_Arena.h"
+#define HGL_PARSE_IMPLEMENTATION
+#include "../Hg/HgL_Parse.h"
+
+#include "../Hg/platform/file.c"
+
+#include "../Hg/platform/meshOpt.c"
+
+#include "../Hg/platform/meshLod.c"
+
+/* The engine's obj parser, only the half that writes .hgmesh files */
+#define HG_OBJ_BAKE_ONLY
+#include "../Hg/platform/objLoad.c"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../Hg/platform/stb_image.h"
+
+#define BAKE_MAX_OPEN_DIRS 16
+
+/* Most nested #include "file" in a shader */
+#define BAKE_MAX_INCLUDE_DEPTH 8
+
+typedef enum BakeKind {
+  BAKE_MESH,
+  BAKE_TEXTURE,
+  BAKE_SHADER
+}BakeKind;
+
+typedef enum BakeResult {
+  BAKE_DONE,
+  BAKE_UP_TO_DATE,
+  BAKE_FAILED
+}BakeResult;
+
+typedef struct BakeJob {
+  char *path;
+  char bakePath[PATH_LENGTH];
+  BakeKind kind;
+  uint64_t size;
+  BakeResult result;
+  HgMeshStats stats;  /* meshes only */
+}BakeJob;
+
+BakeJob *jobs = NULL;
+uint32_t jobCount = 0;
+uint32_t jobCapacity = 0;
+
+/* Next job for a worker to take */
+uint32_t nextJob = 0;
+pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+
+bool isForced = false;
+uint32_t meshLayout = HG_VERTEX_FLOAT;
+
+/* A bake being written, to a temp file renamed into place once it's
+ * complete */
+typedef struct BakeFile {
+  FILE *fp;
+  uint64_t size;
+  char tempPath[PATH_LENGTH];
+  bool isError;
+}BakeFile;
+
+bool hasExtension(const char *path, const char *extension){
+  const char *dot = strrchr(path, '.');
+  return dot != NULL && strcmp(dot, extension) == 0;
+}
+
+int addFile(const char *path,
+            const struct stat *fileStat,
+            int type,
+            struct FTW *ftw){
+  (void)ftw;
+  if(type != FTW_F){
+    return 0;
+  }
+
+  BakeKind kind;
+  const char *extension;
+  if(hasExtension(path, ".obj")){
+    kind = BAKE_MESH;
+    extension = ".hgmesh";
+  }else if(hasExtension(path, ".png") || hasExtension(path, ".jpg")
+           || hasExtension(path, ".tga") || hasExtension(path, ".bmp")){
+    kind = BAKE_TEXTURE;
+    extension = ".hgtex";
+  }else if(hasExtension(path, ".vert")){
+    kind = BAKE_SHADER;
+    extension = ".hgvert";
+  }else if(hasExtension(path, ".frag")){
+    kind = BAKE_SHADER;
+    extension = ".hgfrag";
+  }else{
+    return 0;
+  }
+
+  if(jobCount == jobCapacity){
+    jobCapacity = jobCapacity ? jobCapacity * 2 : 256;
+    jobs = realloc(jobs, jobCapacity * sizeof(BakeJob));
+    if(jobs == NULL){
+      fprintf(stderr, "hgbake: out of memory\n");
+      return -1;
+    }
+  }
+  /* "./res/a.obj" and "res/a.obj" are the same file to the engine */
+  if(strncmp(path, "./", 2) == 0){
+    path += 2;
+  }
+  BakeJob *job = &jobs[jobCount];
+  if(hgBakePath(job->bakePath, PATH_LENGTH, path, extension)){
+    fprintf(stderr, "hgbake: path too long %s\n", path);
+    return -1;
+  }
+  job->path = strdup(path);
+  job->kind = kind;
+  job->size = fileStat->st_size;
+  job->result = BAKE_FAILED;
+  memset(&job->stats, 0, sizeof(HgMeshStats));
+  jobCount++;
+  return 0;
+}
+
+/* Biggest first, so one big file doesn't finish alone at the end */
+int compareJobs(const void *a, const void *b){
+  const BakeJob *jobA = a;
+  const BakeJob *jobB = b;
+  return (jobA->size < jobB->size) - (jobA->size > jobB->size);
+}
+
+/* Same contents as when it was baked. Unlike the engine, the modify time
+ * isn't trusted, copies and checkouts change it */
+bool isSourceUnchanged(const HgBakeSource *source){
+  if(source->path[0] == '\0'){
+    return true;
+  }
+  HgFileMap map = hgMapFile(source->path);
+  bool isUnchanged = map.data != NULL
+                     && map.size == source->size
+                     && hgBakeHash(map.data, map.size) == source->hash;
+  hgUnmapFile(&map);
+  return isUnchanged;
+}
+
+bool isUpToDate(const BakeJob *job){
+  if(isForced || !hgFileExists(job->bakePath)){
+    return false;
+  }
+  HgFileMap map = hgMapFile(job->bakePath);
+  if(map.data == NULL){
+    return false;
+  }
+
+  bool isFresh = false;
+  if(job->kind == BAKE_MESH && map.size >= sizeof(HgMeshHeader)){
+    const HgMeshHeader *header = (const HgMeshHeader*)map.data;
+    bool isCompact = (header->flags & HG_MESH_COMPACT) != 0;
+    isFresh = header->magic == HG_MESH_MAGIC
+              && header->version == HG_MESH_VERSION
+              && isCompact == (meshLayout == HG_VERTEX_COMPACT)
+              && isSourceUnchanged(&header->obj)
+              && isSourceUnchanged(&header->mtl);
+  }else if(job->kind == BAKE_TEXTURE && map.size >= sizeof(HgTexHeader)){
+    const HgTexHeader *header = (const HgTexHeader*)map.data;
+    isFresh = header->magic == HG_TEX_MAGIC
+              && header->version == HG_TEX_VERSION
+              && isSourceUnchanged(&header->source);
+  }else if(job->kind == BAKE_SHADER && map.size >= sizeof(HgShaderHeader)){
+    const HgShaderHeader *header = (const HgShaderHeader*)map.data;
+    isFresh = header->magic == HG_SHADER_MAGIC
+              && header->version == HG_SHADER_VERSION
+              && header->sourceCount <= HG_SHADER_MAX_SOURCES;
+    for(uint32_t i = 0; isFresh && i < header->sourceCount; i++){
+      isFresh = isSourceUnchanged(&header->sources[i]);
+    }
+  }
+  hgUnmapFile(&map);
+  return isFresh;
+}
+
+int bakeOpen(BakeFile *bake, const char *bakePath, uint64_t headerSize){
+  memset(bake, 0, sizeof(BakeFile));
+  snprintf(bake->tempPath, PATH_LENGTH, "%s.tmp", bakePath);
+  bake->fp = fopen(bake->tempPath, "wb");
+  if(bake->fp == NULL){
+    return -1;
+  }
+  /* the header goes in last, once everything it points to is written */
+  static const char zeros[HG_BAKE_ALIGN] = {0};
+  bake->isError = fwrite(zeros, 1, headerSize, bake->fp) != headerSize;
+  bake->size = headerSize;
+  return 0;
+}
+
+/* Returns where the data went, HG_BAKE_ALIGN aligned if isAligned */
+uint64_t bakeWrite(BakeFile *bake,
+                   const void *data,
+                   uint64_t size,
+                   bool isAligned){
+  static const char zeros[HG_BAKE_ALIGN] = {0};
+  uint64_t padding = isAligned
+                     ? (HG_BAKE_ALIGN - bake->size % HG_BAKE_ALIGN)
+                       % HG_BAKE_ALIGN
+                     : 0;
+  if(fwrite(zeros, 1, padding, bake->fp) != padding
+     || fwrite(data, 1, size, bake->fp) != size){
+    bake->isError = true;
+  }
+  bake->size += padding + size;
+  return bake->size - size;
+}
+
+int bakeClose(BakeFile *bake,
+              const char *bakePath,
+              const void *header,
+              uint64_t headerSize){
+  if(fseek(bake->fp, 0, SEEK_SET) != 0
+     || fwrite(header, 1, headerSize, bake->fp) != headerSize){
+    bake->isError = true;
+  }
+  if(fclose(bake->fp) != 0){
+    bake->isError = true;
+  }
+  if(bake->isError || rename(bake->tempPath, bakePath) != 0){
+    remove(bake->tempPath);
+    return -1;
+  }
+  return 0;
+}
+
+/* The name the engine loads the obj by, i.e: hgLoadObjMesh(arena, "cube",
+ * ...) for "res/models/cube.obj", used for faces before any 'o' */
+void meshName(char *name, const char *path){
+  const char *prefix = "res/models/";
+  if(strncmp(path, prefix, strlen(prefix)) == 0){
+    path += strlen(prefix);
+  }
+  snprintf(name, PATH_LENGTH, "%s", path);
+  char *dot = strrchr(name, '.');
+  if(dot != NULL){
+    *dot = '\0';
+  }
+}
+
+int bakeMesh(BakeJob *job){
+  char name[PATH_LENGTH];
+  meshName(name, job->path);
+  return hgObjBake(job->path, job->bakePath, name, meshLayout, &job->stats);
+}
+
+/* How much hgOptimizeMesh cut vertex shader runs, ACMR is vertex shader
+ * runs per triangle, ATVR per vertex, and the triangles at each LOD */
+void printStats(const char *name, const HgMeshStats *stats){
+  printf("hgbake: %s ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%llu triangles)\n",
+         name,
+         hgMeshAcmr(stats, stats->missesBefore),
+         hgMeshAcmr(stats, stats->missesAfter),
+         hgMeshAtvr(stats, stats->missesBefore),
+         hgMeshAtvr(stats, stats->missesAfter),
+         (unsigned long long)stats->triCount);
+  char lodText[HG_LOD_TEXT_LENGTH];
+  hgMeshLodText(stats, lodText, sizeof(lodText));
+  printf("hgbake: %s LODs %s triangles\n", name, lodText);
+}
+
+/* sRGB to linear, so mips average light, not gamma encoded values */
+float srgbToLinear[256];
+
+uint8_t linearToSrgb(float linear){
+  float srgb = (linear <= 0.0031308f)
+               ? linear * 12.92f
+               : 1.055f * powf(linear, 1.0f / 2.4f) - 0.055f;
+  return (uint8_t)(srgb * 255.0f + 0.5f);
+}
+
+/* Next mip, each texel the average of up to 2x2 texels. Colour is
+ * weighted by alpha, so see through texels don't bleed their colour */
+uint8_t* makeMip(const uint8_t *src, uint32_t width, uint32_t height){
+  uint32_t mipWidth = MAX(width / 2, 1);
+  uint32_t mipHeight = MAX(height / 2, 1);
+  uint8_t *mip = malloc((uint64_t)mipWidth * mipHeight * 4);
+  if(mip == NULL){
+    return NULL;
+  }
+  for(uint32_t y = 0; y < mipHeight; y++){
+    for(uint32_t x = 0; x < mipWidth; x++){
+      float colour[3] = {0.0f, 0.0f, 0.0f};
+      float alpha = 0.0f;
+      float count = 0.0f;
+      for(uint32_t dy = 0; dy < 2; dy++){
+        for(uint32_t dx = 0; dx < 2; dx++){
+          uint32_t sx = MIN(x * 2 + dx, width - 1);
+          uint32_t sy = MIN(y * 2 + dy, height - 1);
+          const uint8_t *texel = src + ((uint64_t)sy * width + sx) * 4;
+          float weight = texel[3] / 255.0f;
+          for(int c = 0; c < 3; c++){
+            colour[c] += srgbToLinear[texel[c]] * weight;
+          }
+          alpha += weight;
+          count += 1.0f;
+        }
+      }
+      uint8_t *out = mip + ((uint64_t)y * mipWidth + x) * 4;
+      for(int c = 0; c < 3; c++){
+        out[c] = (alpha > 0.0f) ? linearToSrgb(colour[c] / alpha) : 0;
+      }
+      out[3] = (uint8_t)(alpha / count * 255.0f + 0.5f);
+    }
+  }
+  return mip;
+}
+
+int bakeTexture(const BakeJob *job){
+  HgFileMap map = hgMapFile(job->path);
+  if(map.data == NULL){
+    return -1;
+  }
+  int width;
+  int height;
+  int bpp;
+  /* flipped like hgLoadMeshTexture, the bottom row goes first */
+  uint8_t *pixels = stbi_load_from_memory((const stbi_uc*)map.data,
+                                          (int)map.size,
+                                          &width,
+                                          &height,
+                                          &bpp,
+                                          4);
+  if(pixels == NULL){
+    hgUnmapFile(&map);
+    return -1;
+  }
+
+  HgTexHeader header = {0};
+  header.magic = HG_TEX_MAGIC;
+  header.version = HG_TEX_VERSION;
+  header.width = (uint32_t)width;
+  header.height = (uint32_t)height;
+  hgStampBakeSource(&header.source, job->path, &map);
+  hgUnmapFile(&map);
+
+  BakeFile bake;
+  if(bakeOpen(&bake, job->bakePath, sizeof(HgTexHeader))){
+    stbi_image_free(pixels);
+    return -1;
+  }
+  uint8_t *mip = pixels;
+  uint32_t mipWidth = header.width;
+  uint32_t mipHeight = header.height;
+  while(!bake.isError){
+    if(header.mipCount == HG_TEX_MAX_MIPS){
+      bake.isError = true;
+      break;
+    }
+    header.mipOffsets[header.mipCount++] = bakeWrite(&bake,
+        mip,
+        (uint64_t)mipWidth * mipHeight * 4,
+        true);
+    if(mipWidth == 1 && mipHeight == 1){
+      break;
+    }
+
+    uint8_t *next = makeMip(mip, mipWidth, mipHeight);
+    if(mip != pixels){
+      free(mip);
+    }
+    mip = next;
+    mipWidth = MAX(mipWidth / 2, 1);
+    mipHeight = MAX(mipHeight / 2, 1);
+    if(mip == NULL){
+      bake.isError = true;
+    }
+  }
+  if(mip != pixels){
+    free(mip);
+  }
+  stbi_image_free(pixels);
+  return bakeClose(&bake, job->bakePath, &header, sizeof(HgTexHeader));
+}
+
+/* A shader's text as it's baked */
+typedef struct ShaderText {
+  char *text;
+  uint64_t size;
+  uint64_t capacity;
+  bool inComment; /* inside a block comment */
+  HgShaderHeader header;
+}ShaderText;
+
+int appendText(ShaderText *shader, const char *text, uint64_t size){
+  if(shader->size + size > shader->capacity){
+    shader->capacity = MAX(shader->capacity * 2, shader->size + size + 4096);
+    shader->text = realloc(shader->text, shader->capacity);
+    if(shader->text == NULL){
+      return -1;
+    }
+  }
+  memcpy(shader->text + shader->size, text, size);
+  shader->size += size;
+  return 0;
+}
+
+/* Removes comments from a line, in place. Returns the new length, trailing
+ * space removed */
+uint64_t stripComments(ShaderText *shader, char *line, uint64_t length){
+  uint64_t out = 0;
+  for(uint64_t i = 0; i < length; i++){
+    if(shader->inComment){
+      if(line[i] == '*' && i + 1 < length && line[i + 1] == '/'){
+        shader->inComment = false;
+        i++;
+      }
+    }else if(line[i] == '/' && i + 1 < length && line[i + 1] == '/'){
+      break;
+    }else if(line[i] == '/' && i + 1 < length && line[i + 1] == '*'){
+      shader->inComment = true;
+      i++;
+      /* a block comment between two tokens still splits them */
+      line[out++] = ' ';
+    }else{
+      line[out++] = line[i];
+    }
+  }
+  while(out > 0 && (line[out - 1] == ' ' || line[out - 1] == '\t'
+                    || line[out - 1] == '\r')){
+    out--;
+  }
+  return out;
+}
+
+/* The file's lines into shader, with every #include "file" (relative to
+ * the including file) replaced by that file's lines */
+int appendShader(ShaderText *shader, const char *path, int depth){
+  if(depth > BAKE_MAX_INCLUDE_DEPTH
+     || shader->header.sourceCount == HG_SHADER_MAX_SOURCES){
+    fprintf(stderr, "hgbake: too many includes in %s\n", path);
+    return -1;
+  }
+  HgFileMap map = hgMapFile(path);
+  if(map.data == NULL){
+    fprintf(stderr, "hgbake: can't open %s\n", path);
+    return -1;
+  }
+  hgStampBakeSource(&shader->header.sources[shader->header.sourceCount++],
+                    path,
+                    &map);
+
+  int result = 0;
+  char line[LOG_LENGTH];
+  const char *at = map.data;
+  const char *end = map.data + map.size;
+  while(at < end && result == 0){
+    const char *lineStart = at;
+    const char *lineEnd = memchr(at, '\n', end - at);
+    if(lineEnd == NULL){
+      lineEnd = end;
+    }
+    uint64_t length = lineEnd - lineStart;
+    at = lineEnd + 1;
+    if(length >= LOG_LENGTH){
+      fprintf(stderr, "hgbake: line too long in %s\n", path);
+      result = -1;
+      break;
+    }
+    memcpy(line, lineStart, length);
+    length = stripComments(shader, line, length);
+    line[length] = '\0';
+
+    const char *directive = line + strspn(line, " \t");
+    if(strncmp(directive, "#include", 8) != 0){
+      if(length > 0){
+        result = appendText(shader, line, length) || appendText(shader, "\n", 1);
+      }
+      continue;
+    }
+
+    const char *nameStart = strchr(directive, '"');
+    const char *nameEnd = nameStart ? strchr(nameStart + 1, '"') : NULL;
+    const char *slash = strrchr(path, '/');
+    int dirLength = slash ? (int)(slash - path + 1) : 0;
+    char includePath[PATH_LENGTH];
+    if(nameEnd == NULL
+       || snprintf(includePath, PATH_LENGTH, "%.*s%.*s",
+                   dirLength, path,
+                   (int)(nameEnd - nameStart - 1), nameStart + 1)
+          >= PATH_LENGTH){
+      fprintf(stderr, "hgbake: bad #include in %s: %s\n", path, directive);
+      result = -1;
+      break;
+    }
+    result = appendShader(shader, includePath, depth + 1);
+  }
+  hgUnmapFile(&map);
+  return result;
+}
+
+int bakeShader(const BakeJob *job){
+  ShaderText shader = {0};
+  shader.header.magic = HG_SHADER_MAGIC;
+  shader.header.version = HG_SHADER_VERSION;
+  int result = appendShader(&shader, job->path, 0);
+
+  BakeFile bake;
+  if(result == 0 && bakeOpen(&bake, job->bakePath, sizeof(HgShaderHeader)) == 0){
+    shader.header.textSize = (uint32_t)shader.size;
+    bakeWrite(&bake, shader.text, shader.size, false);
+    result = bakeClose(&bake, job->bakePath,
+                       &shader.header, sizeof(HgShaderHeader));
+  }else{
+    result = -1;
+  }
+  free(shader.text);
+  return result;
+}
+
+void* bakeThread(void *arg){
+  (void)arg;
+  while(true){
+    pthread_mutex_lock(&jobLock);
+    uint32_t i = nextJob++;
+    pthread_mutex_unlock(&jobLock);
+    if(i >= jobCount){
+      return NULL;
+    }
+
+    BakeJob *job = &jobs[i];
+    if(isUpToDate(job)){
+      job->result = BAKE_UP_TO_DATE;
+      continue;
+    }
+    int result = -1;
+    switch(job->kind){
+      case BAKE_MESH: result = bakeMesh(job); break;
+      case BAKE_TEXTURE: result = bakeTexture(job); break;
+      case BAKE_SHADER: result = bakeShader(job); break;
+      default: break;
+    }
+    job->result = result ? BAKE_FAILED : BAKE_DONE;
+    if(result){
+      fprintf(stderr, "hgbake: failed to bake %s\n", job->path);
+    }else if(job->kind == BAKE_MESH){
+      char name[2 * PATH_LENGTH];
+      snprintf(name, sizeof(name), "%s -> %s,", job->path, job->bakePath);
+      printStats(name, &job->stats);
+    }else{
+      printf("hgbake: %s -> %s\n", job->path, job->bakePath);
+    }
+  }
+}
+
+int main(int argc, char **argv){
+  long threadCount = sysconf(_SC_NPROCESSORS_ONLN);
+  int arg = 1;
+  for(; arg < argc && argv[arg][0] == '-'; arg++){
+    if(strcmp(argv[arg], "-f") == 0){
+      isForced = true;
+    }else if(strcmp(argv[arg], "-c") == 0){
+      meshLayout = HG_VERTEX_COMPACT;
+    }else if(strcmp(argv[arg], "-j") == 0 && arg + 1 < argc){
+      threadCount = atol(argv[++arg]);
+    }else{
+      break;
+    }
+  }
+  if(arg >= argc){
+    fprintf(stderr,
+            "usage: %s [-f] [-c] [-j jobs] dir [dir or file...]\n", argv[0]);
+    return 1;
+  }
+  threadCount = MAX(threadCount, 1);
+
+  for(; arg < argc; arg++){
+    if(nftw(argv[arg], addFile, BAKE_MAX_OPEN_DIRS, FTW_PHYS) != 0){
+      fprintf(stderr, "hgbake: failed to read %s\n", argv[arg]);
+      return 1;
+    }
+  }
+  qsort(jobs, jobCount, sizeof(BakeJob), compareJobs);
+
+  for(int i = 0; i < 256; i++){
+    float srgb = i / 255.0f;
+    srgbToLinear[i] = (srgb <= 0.04045f)
+                      ? srgb / 12.92f
+                      : powf((srgb + 0.055f) / 1.055f, 2.4f);
+  }
+  stbi_set_flip_vertically_on_load(1);
+
+  threadCount = MIN(threadCount, (long)MAX(jobCount, 1));
+  pthread_t *threads = malloc(threadCount * sizeof(pthread_t));
+  if(threads == NULL){
+    fprintf(stderr, "hgbake: out of memory\n");
+    return 1;
+  }
+  for(long i = 0; i < threadCount; i++){
+    if(pthread_create(&threads[i], NULL, bakeThread, NULL) != 0){
+      threadCount = i;
+      break;
+    }
+  }
+  /* with no threads at all, bake here */
+  if(threadCount == 0){
+    bakeThread(NULL);
+  }
+  for(long i = 0; i < threadCount; i++){
+    pthread_join(threads[i], NULL);
+  }
+
+  uint32_t counts[3] = {0};
+  HgMeshStats total = {0};
+  for(uint32_t i = 0; i < jobCount; i++){
+    counts[jobs[i].result]++;
+    hgAddMeshStats(&total, &jobs[i].stats);
+  }
+  if(total.triCount > 0){
+    printStats("every mesh baked,", &total);
+  }
+  printf("hgbake: %u baked, %u up to date, %u failed\n",
+         counts[BAKE_DONE], counts[BAKE_UP_TO_DATE], counts[BAKE_FAILED]);
+  return counts[BAKE_FAILED] ? 1 : 0;
+}
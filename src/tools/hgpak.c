@@ -0,0 +1,336 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: Packs asset directories into a .hgpak archive (see
+ *  Hg/platform/hgpak.h). Entries are named by their path, so run it from
+ *  the same directory the game runs from.
+ *
+ *  Files that shrink enough are stored LZ4 compressed, in chunks the
+ *  engine can decode in parallel.
+ *
+ *  Usage: hgpak [-r] out.hgpak res [more directories or files...]
+ *    -r : store every file raw (uncompressed)
+ */
+
+/* nftw */
+#define _XOPEN_SOURCE 500
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//POSIX
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "../Hg/platform/hgpak.h"
+
+#define PAK_MAX_OPEN_DIRS 16
+
+/* Only compress if it saves at least 1/8th of the file */
+#define PAK_MIN_SAVING 8
+
+/* LZ4 block rules: the last 5 bytes are always literals, and the last
+ * match starts at least 12 bytes before the end */
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MF_LIMIT 12
+#define LZ4_HASH_BITS 16
+
+typedef struct PakFile {
+  char *name;
+  uint64_t size;
+  uint8_t *data;      /* what goes in the archive */
+  uint64_t dataSize;
+  uint32_t flags;
+}PakFile;
+
+PakFile *files = NULL;
+uint32_t fileCount = 0;
+uint32_t fileCapacity = 0;
+
+int addFile(const char *path,
+            const struct stat *fileStat,
+            int type,
+            struct FTW *ftw){
+  (void)ftw;
+  if(type != FTW_F){
+    return 0;
+  }
+  if(fileCount == fileCapacity){
+    fileCapacity = fileCapacity ? fileCapacity * 2 : 256;
+    files = realloc(files, fileCapacity * sizeof(PakFile));
+    if(files == NULL){
+      fprintf(stderr, "hgpak: out of memory\n");
+      return -1;
+    }
+  }
+  /* "./res/a.obj" and "res/a.obj" are the same file to the engine */
+  if(strncmp(path, "./", 2) == 0){
+    path += 2;
+  }
+  files[fileCount].name = strdup(path);
+  files[fileCount].size = fileStat->st_size;
+  fileCount++;
+  return 0;
+}
+
+uint64_t alignUp(uint64_t value){
+  return (value + HG_PAK_ALIGN - 1) & ~(uint64_t)(HG_PAK_ALIGN - 1);
+}
+
+uint8_t* readFile(const PakFile *file){
+  FILE *fp = fopen(file->name, "rb");
+  if(fp == NULL){
+    fprintf(stderr, "hgpak: can't open %s\n", file->name);
+    return NULL;
+  }
+  uint8_t *data = malloc(file->size ? file->size : 1);
+  if(data == NULL || fread(data, 1, file->size, fp) != file->size){
+    fprintf(stderr, "hgpak: can't read %s\n", file->name);
+    free(data);
+    data = NULL;
+  }
+  fclose(fp);
+  return data;
+}
+
+uint32_t read32(const uint8_t *p){
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint8_t* writeLength(uint8_t *out, uint64_t length){
+  while(length >= 255){
+    *out++ = 255;
+    length -= 255;
+  }
+  *out++ = (uint8_t)length;
+  return out;
+}
+
+/* One LZ4 sequence: literals, then a match (none for the last one) */
+uint8_t* writeSequence(uint8_t *out,
+                       const uint8_t *literals,
+                       uint64_t literalLength,
+                       uint64_t offset,
+                       uint64_t matchLength){
+  uint8_t *token = out++;
+  *token = (literalLength >= 15 ? 15 : literalLength) << 4;
+  if(literalLength >= 15){
+    out = writeLength(out, literalLength - 15);
+  }
+  memcpy(out, literals, literalLength);
+  out += literalLength;
+
+  if(matchLength == 0){
+    return out;
+  }
+  *out++ = offset & 0xff;
+  *out++ = (offset >> 8) & 0xff;
+  matchLength -= 4;
+  *token |= (matchLength >= 15 ? 15 : matchLength);
+  if(matchLength >= 15){
+    out = writeLength(out, matchLength - 15);
+  }
+  return out;
+}
+
+/* Greedy LZ4 block compressor, out needs compressBound(size) bytes */
+uint64_t compressBound(uint64_t size){
+  return size + size / 255 + 16;
+}
+
+uint64_t compressBlock(const uint8_t *src, uint64_t size, uint8_t *dst){
+  static int64_t table[1 << LZ4_HASH_BITS];
+  for(int i = 0; i < (1 << LZ4_HASH_BITS); i++){
+    table[i] = -1;
+  }
+
+  uint8_t *out = dst;
+  uint64_t anchor = 0;
+  uint64_t ip = 0;
+  while(size >= LZ4_MF_LIMIT && ip < size - LZ4_MF_LIMIT){
+    uint32_t sequence = read32(src + ip);
+    uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+    int64_t ref = table[hash];
+    table[hash] = ip;
+
+    if(ref < 0 || ip - ref > 65535 || read32(src + ref) != sequence){
+      ip++;
+      continue;
+    }
+
+    uint64_t length = 4;
+    while(ip + length < size - LZ4_LAST_LITERALS
+          && src[ref + length] == src[ip + length]){
+      length++;
+    }
+    out = writeSequence(out, src + anchor, ip - anchor, ip - ref, length);
+    ip += length;
+    anchor = ip;
+  }
+  out = writeSequence(out, src + anchor, size - anchor, 0, 0);
+  return out - dst;
+}
+
+/* Chunked and compressed, see hgpak.h. Returns 0 if it didn't pay off */
+uint64_t compressFile(const uint8_t *raw, uint64_t size, uint8_t **out){
+  uint32_t chunkCount = (size + HG_PAK_CHUNK_SIZE - 1) / HG_PAK_CHUNK_SIZE;
+  uint64_t tableSize = sizeof(HgPakChunks) + (chunkCount + 1) * sizeof(uint64_t);
+  uint8_t *data = malloc(tableSize + chunkCount * compressBound(HG_PAK_CHUNK_SIZE));
+  if(data == NULL){
+    return 0;
+  }
+
+  HgPakChunks chunks = {chunkCount, HG_PAK_CHUNK_SIZE};
+  memcpy(data, &chunks, sizeof(HgPakChunks));
+  uint64_t *offsets = (uint64_t*)(data + sizeof(HgPakChunks));
+
+  uint64_t position = tableSize;
+  for(uint32_t i = 0; i < chunkCount; i++){
+    uint64_t start = (uint64_t)i * HG_PAK_CHUNK_SIZE;
+    uint64_t rawSize = (size - start < HG_PAK_CHUNK_SIZE)
+                       ? size - start : HG_PAK_CHUNK_SIZE;
+    offsets[i] = position;
+    position += compressBlock(raw + start, rawSize, data + position);
+
+    /* never ship a block the engine can't read back */
+    uint8_t *check = malloc(rawSize);
+    if(check == NULL
+       || hgPakDecodeBlock(data + offsets[i], position - offsets[i],
+                           check, rawSize) != 0
+       || memcmp(check, raw + start, rawSize) != 0){
+      fprintf(stderr, "hgpak: compression check failed\n");
+      free(check);
+      free(data);
+      return 0;
+    }
+    free(check);
+  }
+  offsets[chunkCount] = position;
+
+  if(position > size - size / PAK_MIN_SAVING){
+    free(data);
+    return 0;
+  }
+  *out = data;
+  return position;
+}
+
+int main(int argc, char **argv){
+  bool isRaw = argc > 1 && strcmp(argv[1], "-r") == 0;
+  if(isRaw){
+    argc--;
+    argv++;
+  }
+  if(argc < 3){
+    fprintf(stderr, "usage: %s [-r] out.hgpak dir [dir or file...]\n", argv[0]);
+    return 1;
+  }
+
+  for(int i = 2; i < argc; i++){
+    if(nftw(argv[i], addFile, PAK_MAX_OPEN_DIRS, FTW_PHYS) != 0){
+      fprintf(stderr, "hgpak: failed to read %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  uint64_t rawTotal = 0;
+  for(uint32_t i = 0; i < fileCount; i++){
+    PakFile *file = &files[i];
+    file->data = readFile(file);
+    if(file->data == NULL){
+      return 1;
+    }
+    file->dataSize = file->size;
+    file->flags = 0;
+    rawTotal += file->size;
+
+    uint8_t *compressed = NULL;
+    uint64_t compressedSize = (isRaw || file->size == 0)
+                              ? 0 : compressFile(file->data, file->size, &compressed);
+    if(compressedSize > 0){
+      free(file->data);
+      file->data = compressed;
+      file->dataSize = compressedSize;
+      file->flags = HG_PAK_COMPRESSED;
+    }
+  }
+
+  /* At most half full, so probes stay short */
+  uint32_t bucketCount = 1;
+  while(bucketCount < fileCount * 2){
+    bucketCount *= 2;
+  }
+
+  HgPakEntry *entries = calloc(bucketCount, sizeof(HgPakEntry));
+  if(entries == NULL){
+    fprintf(stderr, "hgpak: out of memory\n");
+    return 1;
+  }
+
+  uint64_t namesOffset = sizeof(HgPakHeader) + bucketCount * sizeof(HgPakEntry);
+  uint64_t namesSize = 0;
+  for(uint32_t i = 0; i < fileCount; i++){
+    namesSize += strlen(files[i].name) + 1;
+  }
+
+  uint64_t nameOffset = namesOffset;
+  uint64_t dataOffset = alignUp(namesOffset + namesSize);
+  for(uint32_t i = 0; i < fileCount; i++){
+    uint64_t hash = hgPakHash(files[i].name);
+    uint32_t bucket = hash & (bucketCount - 1);
+    while(entries[bucket].hash != 0){
+      bucket = (bucket + 1) & (bucketCount - 1);
+    }
+    entries[bucket].hash = hash;
+    entries[bucket].offset = dataOffset;
+    entries[bucket].size = files[i].dataSize;
+    entries[bucket].rawSize = files[i].size;
+    entries[bucket].nameOffset = (uint32_t)nameOffset;
+    entries[bucket].flags = files[i].flags;
+
+    nameOffset += strlen(files[i].name) + 1;
+    dataOffset = alignUp(dataOffset + files[i].dataSize);
+  }
+
+  FILE *pak = fopen(argv[1], "wb");
+  if(pak == NULL){
+    fprintf(stderr, "hgpak: can't create %s\n", argv[1]);
+    return 1;
+  }
+
+  HgPakHeader header = {HG_PAK_MAGIC, HG_PAK_VERSION, fileCount, bucketCount};
+  fwrite(&header, sizeof(HgPakHeader), 1, pak);
+  fwrite(entries, sizeof(HgPakEntry), bucketCount, pak);
+  for(uint32_t i = 0; i < fileCount; i++){
+    fwrite(files[i].name, 1, strlen(files[i].name) + 1, pak);
+  }
+
+  /* Data goes in file order, the table is only for finding it */
+  static const char zeros[HG_PAK_ALIGN] = {0};
+  uint64_t position = namesOffset + namesSize;
+  for(uint32_t i = 0; i < fileCount; i++){
+    fwrite(zeros, 1, alignUp(position) - position, pak);
+    position = alignUp(position);
+    fwrite(files[i].data, 1, files[i].dataSize, pak);
+    position += files[i].dataSize;
+  }
+
+  if(ferror(pak)){
+    fprintf(stderr, "hgpak: failed writing %s\n", argv[1]);
+    fclose(pak);
+    remove(argv[1]);
+    return 1;
+  }
+  fclose(pak);
+  printf("hgpak: packed %u files into %s (%llu bytes, %llu raw)\n",
+         fileCount, argv[1],
+         (unsigned long long)position, (unsigned long long)rawTotal);
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*
+ *  Author: Gwenivere Benzschawel
+ *  Copyright: 2024
+ *  License: MIT
+ *
+ *  Purpose: Times HgL_Parse against libc (strtof/atof and strtol/atoi) on
+ *  the numbers in real model files, and checks they agree bit for bit.
+ *
+ *  Usage: numbench file.obj [more files...]
+ */
+
+/* clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define HGL_PARSE_IMPLEMENTATION
+#include "../Hg/HgL_Parse.h"
+
+/* Each parser is timed this many times over every number, best run wins */
+#define BENCH_RUNS 10
+
+typedef struct Number {
+  const char *start;
+  const char *end;
+}Number;
+
+typedef struct Numbers {
+  Number *numbers;
+  uint64_t count;
+  uint64_t capacity;
+  uint64_t bytes;
+}Numbers;
+
+Numbers floats = {0};
+Numbers ints = {0};
+
+/* Results go here so the compiler can't drop the parsing */
+volatile double sink = 0.0;
+
+void addNumber(Numbers *numbers, const char *start, const char *end){
+  if(numbers->count == numbers->capacity){
+    numbers->capacity = numbers->capacity ? numbers->capacity * 2 : 4096;
+    numbers->numbers = realloc(numbers->numbers,
+                               numbers->capacity * sizeof(Number));
+    if(numbers->numbers == NULL){
+      fprintf(stderr, "numbench: out of memory\n");
+      exit(1);
+    }
+  }
+  numbers->numbers[numbers->count].start = start;
+  numbers->numbers[numbers->count].end = end;
+  numbers->count++;
+  numbers->bytes += end - start;
+}
+
+bool isSpace(char c){
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/* Every number on v/vt/vn lines is a float, on f lines an int */
+void findNumbers(const char *text){
+  const char *at = text;
+  while(*at){
+    const char *lineEnd = strchr(at, '\n');
+    if(lineEnd == NULL){
+      lineEnd = at + strlen(at);
+    }
+    bool isFloat = (at[0] == 'v' && (isSpace(at[1])
+                    || ((at[1] == 't' || at[1] == 'n') && isSpace(at[2]))));
+    bool isInt = (at[0] == 'f' && isSpace(at[1]));
+
+    if(isFloat || isInt){
+      const char *p = at + 2;
+      while(p < lineEnd){
+        while(p < lineEnd && (isSpace(*p) || *p == '/')){
+          p++;
+        }
+        const char *start = p;
+        while(p < lineEnd && !isSpace(*p) && *p != '/'){
+          p++;
+        }
+        if(p > start){
+          addNumber(isFloat ? &floats : &ints, start, p);
+        }
+      }
+    }
+    at = (*lineEnd) ? lineEnd + 1 : lineEnd;
+  }
+}
+
+char* readFile(const char *path){
+  FILE *fp = fopen(path, "rb");
+  if(fp == NULL){
+    fprintf(stderr, "numbench: can't open %s\n", path);
+    return NULL;
+  }
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  /* null terminated so strtof can't run off the end */
+  char *text = malloc(size + 1);
+  if(text == NULL || fread(text, 1, size, fp) != (size_t)size){
+    fprintf(stderr, "numbench: can't read %s\n", path);
+    free(text);
+    fclose(fp);
+    return NULL;
+  }
+  text[size] = '\0';
+  fclose(fp);
+  return text;
+}
+
+double nowMs(void){
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec * 1e3 + time.tv_nsec / 1e6;
+}
+
+typedef enum Parser {
+  PARSE_HG_FLOAT,
+  PARSE_STRTOF,
+  PARSE_ATOF,
+  PARSE_HG_INT,
+  PARSE_STRTOL,
+  PARSE_ATOI,
+  PARSE_COUNT
+}Parser;
+
+const char *parserNames[PARSE_COUNT] = {
+  "hgParseFloat", "strtof", "atof", "hgParseInt", "strtol", "atoi"
+};
+
+double runParser(Parser parser, const Numbers *numbers){
+  double best = 0.0;
+  for(int run = 0; run < BENCH_RUNS; run++){
+    double sum = 0.0;
+    double start = nowMs();
+    for(uint64_t i = 0; i < numbers->count; i++){
+      const char *str = numbers->numbers[i].start;
+      const char *end = numbers->numbers[i].end;
+      float f = 0.0f;
+      int64_t n = 0;
+      switch(parser){
+        case PARSE_HG_FLOAT: hgParseFloat(str, end, &f); sum += f; break;
+        case PARSE_STRTOF: sum += strtof(str, NULL); break;
+        case PARSE_ATOF: sum += atof(str); break;
+        case PARSE_HG_INT: hgParseInt(str, end, &n); sum += n; break;
+        case PARSE_STRTOL: sum += strtol(str, NULL, 10); break;
+        case PARSE_ATOI: sum += atoi(str); break;
+        default: break;
+      }
+    }
+    double time = nowMs() - start;
+    sink += sum;
+    if(run == 0 || time < best){
+      best = time;
+    }
+  }
+  return best;
+}
+
+/* Anywhere hgParseFloat and strtof don't give the exact same float */
+uint64_t countMismatches(const Numbers *numbers){
+  uint64_t mismatches = 0;
+  for(uint64_t i = 0; i < numbers->count; i++){
+    const Number *number = &numbers->numbers[i];
+    float hg = 0.0f;
+    hgParseFloat(number->start, number->end, &hg);
+    float libc = strtof(number->start, NULL);
+    if(memcmp(&hg, &libc, sizeof(float)) != 0 && !(hg != hg && libc != libc)){
+      if(mismatches < 10){
+        fprintf(stderr, "numbench: mismatch %.*s -> %.9g, strtof %.9g\n",
+                (int)(number->end - number->start), number->start, hg, libc);
+      }
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+void report(Parser first, Parser last, const Numbers *numbers){
+  if(numbers->count == 0){
+    return;
+  }
+  double baseline = 0.0;
+  for(Parser parser = first; parser <= last; parser++){
+    double ms = runParser(parser, numbers);
+    if(parser == first){
+      baseline = ms;
+    }
+    printf("  %-13s %9.2f ms %7.1f ns/number %8.1f MB/s %6.2fx\n",
+           parserNames[parser], ms,
+           ms * 1e6 / numbers->count,
+           numbers->bytes / (ms * 1e3),
+           ms / baseline);
+  }
+}
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "usage: %s file.obj [more files...]\n", argv[0]);
+    return 1;
+  }
+
+  /* Every file is kept, the numbers point into them */
+  for(int i = 1; i < argc; i++){
+    char *text = readFile(argv[i]);
+    if(text == NULL){
+      return 1;
+    }
+    findNumbers(text);
+  }
+
+  printf("%llu floats (%llu bytes), %llu ints (%llu bytes), best of %d runs\n",
+         (unsigned long long)floats.count, (unsigned long long)floats.bytes,
+         (unsigned long long)ints.count, (unsigned long long)ints.bytes,
+         BENCH_RUNS);
+  report(PARSE_HG_FLOAT, PARSE_ATOF, &floats);
+  report(PARSE_HG_INT, PARSE_ATOI, &ints);
+
+  uint64_t mismatches = countMismatches(&floats);
+  printf("%llu floats differ from strtof\n", (unsigned long long)mismatches);
+  return mismatches ? 1 : 0;
+}